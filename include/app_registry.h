@@ -25,7 +25,12 @@ struct AppDefinition {
     std::string id;                          // AppRegistry 정의 id
     std::string displayName;                 // "Unity"
     std::vector<std::wstring> processNames;   // L"Unity.exe" 등 (소문자 비교)
+    std::vector<std::wstring> helperProcessNames; // 인스턴스가 띄우면 그 인스턴스로 묶는 보조 exe (processNames 외, 해석하지 않는다)
     std::vector<std::string> fileExtensions;  // 감시/커맨드라인 후보 확장자 필터
+    std::vector<std::string> lineCountExtensions; // DirectoryWatch: 줄 수를 세어 heartbeat에 싣는 텍스트 확장자
+    std::vector<std::string> watchRoots;      // DirectoryWatch: 감시할 프로젝트 하위 폴더 (비어 있으면 프로젝트 루트 전체)
+    std::string packageManifest;              // DirectoryWatch: 로컬(file:) 패키지 목록이 있는 manifest (프로젝트 기준, 없으면 빈 값)
+    std::string metadataFile;                 // DirectoryWatch: 에디터 버전 등이 든 파일 (프로젝트 기준, 바뀌면 메타데이터 캐시 무효화)
     std::string language;                    // WakaTime language
     std::string editor;                      // WakaTime editor 베이스 이름
     TrackStrategy strategy;
@@ -41,9 +46,16 @@ namespace AppRegistry
 
     /**
      * 프로세스 exe 이름으로 정의 조회 (대소문자 무시).
+     * 등록된 이름과 길이가 다르면 문자열을 만들지 않고 바로 거절한다 (전체 스냅샷의 대부분).
      * @return 매칭되는 정의, 없으면 nullptr
      */
-    const AppDefinition* FindByProcessName(const std::wstring& exe);
+    const AppDefinition* FindByProcessName(std::wstring_view exe);
+
+    /**
+     * 보조 프로세스로 묶을 수 있는 exe 이름(processNames + helperProcessNames)으로 정의 조회 (대소문자 무시).
+     * @return 매칭되는 정의, 없으면 nullptr
+     */
+    const AppDefinition* FindByHelperName(std::wstring_view exe);
 
     /**
      * 앱 id로 정의 조회.
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "globals.h"
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+/**
+ * 쓰기 이벤트의 내용 변경 여부 확인기.
+ * Unity 리임포트/도메인 리로드는 내용이 같은 .asset/.prefab/.json 을 다시 쓰므로,
+ * 파일을 메모리 매핑해 XXH64로 해시하고 직전 해시와 같으면 "내용 변경 없음"으로 본다.
+ *
+ * 텍스트 에셋은 같은 매핑에서 줄 수도 세어 heartbeat의 lines 메타데이터로 쓴다.
+ *
+ * (경로 → 크기, 수정 시각, 해시, 줄 수) 캐시는 LRU로 상한을 둔다.
+ * 크기/수정 시각이 캐시와 같으면 파일을 다시 읽지 않는다.
+ *
+ * 스레드 안전하지 않다. 한 프로젝트의 감시 스레드에서만 사용한다.
+ */
+class ContentVerifier {
+public:
+    struct LineStats {
+        int64_t lines = -1;    // 파일 줄 수, 모르면 -1 (바이너리/읽기 실패)
+        int64_t lineDelta = 0; // 직전에 센 줄 수 대비 증감 (처음 세면 0)
+    };
+
+    explicit ContentVerifier(size_t capacity = kDefaultCapacity);
+
+    /**
+     * 파일 내용이 마지막으로 본 내용과 다른지 확인하고 캐시를 갱신한다.
+     * 처음 보는 파일, 읽을 수 없는 파일(잠김/삭제), 너무 큰 파일은 변경된 것으로 본다.
+     * @param key 캐시 키 (프로젝트 기준 상대 경로)
+     * @param fullPath 실제 파일 경로
+     * @param lineStats nullptr가 아니면 같은 매핑에서 줄 수를 세어 채운다 (텍스트 에셋용)
+     * @return 내용이 바뀌었으면(또는 판단할 수 없으면) true
+     */
+    bool HasContentChanged(const std::string& key, const std::wstring& fullPath, LineStats* lineStats = nullptr);
+
+    /**
+     * 캐시에서 경로를 제거한다 (삭제/이름 변경 시).
+     */
+    void Forget(const std::string& key);
+
+    /**
+     * XXH64 (seed 0).
+     */
+    static uint64_t Hash(const void* data, size_t length);
+
+    /**
+     * 줄 수 ('\n' 개수, 마지막 줄이 개행으로 끝나지 않으면 +1). x86/x64는 SSE2로 16바이트씩 센다.
+     */
+    static int64_t CountLines(const void* data, size_t length);
+
+private:
+    static constexpr size_t kDefaultCapacity = 4096;
+
+    struct Entry {
+        uint64_t size;
+        uint64_t writeTime; // FILETIME
+        uint64_t hash;
+        int64_t lines; // 세지 않았거나 바이너리면 -1
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    size_t capacity;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // 앞쪽이 최근
+
+    /**
+     * 파일을 매핑해 해시한다. lines가 nullptr가 아니면 텍스트일 때 줄 수도 센다 (바이너리면 -1).
+     */
+    static bool HashFile(const std::wstring& fullPath, uint64_t size, uint64_t& hash, int64_t* lines);
+    void Store(const std::string& key, uint64_t size, uint64_t writeTime, uint64_t hash, int64_t lines);
+};
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "globals.h"
+#include "ignore_rules.h"
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * 프로젝트별 추적 파일 인덱스 (상대 경로 → 크기, 수정 시각) + 디렉토리 목록.
+ * %APPDATA%/creative-wakatime/index/ 아래에 경로 정렬된 고정 크기 레코드로 저장하고,
+ * 읽을 때는 파일을 메모리 매핑해 이진 탐색한다. 로드 이후 변경분은 overlay에만 쌓고 Save()에서 합친다.
+ *
+ * Refresh()는 범위(scope) 안의 디렉토리를 전부 다시 열거한다 (범위 밖은 보지 않는다).
+ *  - 인덱스 디렉토리마다 FindFirstFileExW(LARGE_FETCH)를 한 번씩 돌려, 열거 결과의 크기/수정 시각을
+ *    인덱스와 비교해 바뀐 파일·없어진 파일을 찾는다. 파일을 하나씩 stat 하지 않는다 (디렉토리당 시스템 호출 몇 번).
+ *  - 인덱스에 없던 하위 디렉토리는 이어서 내려간다.
+ * 디렉토리 수정 시각은 파일 내용이 바뀌어도 그대로라 건너뛸 근거가 되지 않으므로 저장하지 않는다.
+ * 대신 오버플로 복구는 유실이 난 감시 root 아래만 범위로 준다. 인덱스가 비어 있으면 루트가 "새 디렉토리"로 취급되어 한 번 전체 열거한다.
+ *
+ * 스레드 안전하지 않다. 호출 측(FileWatcher)이 프로젝트별 indexMutex로 직렬화한다.
+ */
+class FileIndex {
+public:
+    struct FileEntry {
+        uint64_t size = 0;
+        uint64_t writeTime = 0; // FILETIME (100ns 단위)
+    };
+
+    struct Change {
+        std::string relativePath; // '/' 구분 상대 경로
+        uint64_t writeTime;       // FILETIME (100ns 단위)
+        DWORD action;             // FILE_ACTION_ADDED / FILE_ACTION_MODIFIED
+    };
+
+    FileIndex(std::string projectPath, std::shared_ptr<const IgnoreRules> ignoreRules,
+              std::unordered_set<std::string> extensions);
+    ~FileIndex();
+
+    FileIndex(const FileIndex&) = delete;
+    FileIndex& operator=(const FileIndex&) = delete;
+
+    /**
+     * 저장된 인덱스 파일을 매핑한다. 파일이 없거나 형식이 맞지 않으면 false (빈 인덱스로 시작).
+     */
+    bool Load();
+
+    /**
+     * 현재 내용(매핑 + overlay)을 임시 파일에 쓰고 원자적으로 교체한 뒤 다시 매핑한다.
+     * 변경이 없으면 헤더의 저장 시각만 갱신한다.
+     * @param advanceSavedTime false면 저장 시각을 그대로 둔다 (저장된 스냅샷이 없을 때만 지금으로 기록).
+     *        감시 중간 저장이 다음 실행의 오프라인 구간 시작을 직전 종료 시각에서 옮기지 않게 한다.
+     */
+    bool Save(bool advanceSavedTime = true);
+
+    /**
+     * 디스크와 인덱스의 차이를 찾아 인덱스를 갱신한다 (삭제는 조용히 반영).
+     * 디렉토리 열거는 WorkStealingPool로 병렬 처리한다.
+     * @param cancel true가 되면 중간에 멈춘다 (열거를 마친 디렉토리만 반영, 나머지는 다음에 다시 열거)
+     * @param maxChanges 반환할 변경 수 상한
+     * @param scopes 다시 볼 디렉토리 (상대 경로, '/' 구분자). 빈 문자열이면 프로젝트 전체
+     * @param since, until 보고할 수정 시각 구간 (since, until] (FILETIME). 인덱스는 구간과 무관하게 모두 갱신한다
+     * @param changedFiles 구간 안의 추가/수정 파일 총수 (maxChanges와 무관, 필요 없으면 nullptr)
+     * @return 구간 안의 추가/수정 파일 중 최근 수정 순 상위 maxChanges개
+     */
+    std::vector<Change> Refresh(const std::atomic<bool>& cancel, size_t maxChanges,
+                                const std::vector<std::string>& scopes, uint64_t since = 0,
+                                uint64_t until = UINT64_MAX, size_t* changedFiles = nullptr);
+
+    /**
+     * 감시 이벤트 반영: 추적 파일이 추가/수정되었다. 크기/시각은 직접 stat 한다.
+     */
+    void UpdateFile(const std::string& relativePath);
+
+    /**
+     * 감시 이벤트 반영: 경로가 삭제되었다. 디렉토리이면 하위 항목도 모두 제거한다.
+     */
+    void RemovePath(const std::string& relativePath);
+
+    /**
+     * 인덱스에 있는 파일 수 (overlay 반영).
+     */
+    size_t FileCount() const;
+
+    /**
+     * 저장된 인덱스가 없어 이번 실행에서 처음 만든 인덱스인지.
+     */
+    bool IsFresh() const { return !loaded; }
+
+    /**
+     * 매핑된 스냅샷을 저장한 시각 (FILETIME, 100ns 단위). 스냅샷이 없으면 0.
+     * 이 시각 이후 수정된 파일이 "추적기가 꺼져 있던 동안"의 변경이다.
+     */
+    uint64_t SavedTime() const { return savedTime; }
+
+private:
+    // 디스크 레코드 (고정 크기, 경로 오름차순)
+    struct FileRecord {
+        uint64_t size;
+        uint64_t writeTime;
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    struct DirRecord {
+        uint32_t pathOffset;
+        uint32_t pathLength;
+    };
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t fileCount;
+        uint32_t dirCount;
+        uint64_t stringBytes;
+        uint64_t savedTime;  // FILETIME
+    };
+
+    std::string projectPath;
+    std::wstring rootPath;  // 끝에 '\' 없음
+    std::wstring indexFilePath;
+    std::shared_ptr<const IgnoreRules> ignoreRules;
+    std::unordered_set<std::string> extensions;
+
+    // 매핑된 스냅샷 (Load/Save 이후 불변)
+    HANDLE mappingFile = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    const char* view = nullptr;
+    const FileRecord* files = nullptr;
+    const DirRecord* dirs = nullptr;
+    const char* strings = nullptr;
+    uint32_t fileCount = 0;
+    uint32_t dirCount = 0;
+    uint64_t savedTime = 0;
+    bool loaded = false;
+
+    // 스냅샷 이후 변경분. 파일은 nullopt, 디렉토리는 false가 삭제 표시.
+    std::unordered_map<std::string, std::optional<FileEntry>> fileOverlay;
+    std::unordered_map<std::string, bool> dirOverlay;
+    bool dirty = false;
+
+    static std::wstring IndexFilePathFor(const std::string& projectPath);
+
+    void Unmap();
+    bool MapFile();
+    bool TouchSavedTime();
+
+    std::string_view FilePathAt(uint32_t index) const;
+    std::string_view DirPathAt(uint32_t index) const;
+    uint32_t LowerBoundFile(std::string_view path) const; // 스냅샷 이진 탐색
+    uint32_t LowerBoundDir(std::string_view path) const;
+    std::optional<FileEntry> FindFile(const std::string& relativePath) const;
+    bool HasDir(const std::string& relativePath) const;
+
+    void SetFile(const std::string& relativePath, const FileEntry& entry);
+    void AddDir(const std::string& relativePath);
+    void EraseFile(const std::string& relativePath);
+    void EraseDirTree(const std::string& relativePath);
+
+    bool IsTracked(const std::string& relativePath) const;
+    std::wstring FullPath(const std::string& relativePath) const;
+};
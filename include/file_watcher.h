@@ -1,41 +1,131 @@
 #pragma once
 
 #include "globals.h"
-#include <deque>
+#include "content_verifier.h"
+#include "file_index.h"
+#include "git_branch_resolver.h"
+#include "ignore_rules.h"
+#include "spsc_ring.h"
+#include "watch_registry.h"
+#include <unordered_map>
 #include <unordered_set>
 
+struct AppDefinition;
+
 /**
  * 추적 대상 앱(현재 Unity)의 프로젝트 폴더 변경을 ReadDirectoryChangesW로 재귀 감시한다.
- * 확장자 필터는 앱 정의(AppRegistry)의 fileExtensions를 사용한다.
+ * 감시 범위는 앱 정의(AppRegistry)의 watchRoots 하위 폴더로 좁히고, 확장자 필터는 fileExtensions를 사용한다.
+ *
+ * 프로젝트마다 감시 스레드(생산자) → SPSC 링 → 메인 스레드(소비자)로 이벤트를 넘긴다.
+ * 링의 소비자는 하나여야 하므로 StartWatching·StopWatching 계열·DrainPendingEvents는 같은 스레드(트레이 메시지 루프)에서 호출한다.
  */
 class FileWatcher {
+public:
+    // 시각 순으로 정렬된 이벤트 배열 [events, events + count). 호출 중에만 유효하다.
+    using ChangeBatchCallback = std::function<void(const FileChangeEvent* events, size_t count)>;
+
+    // 메시지 루프 1회 드레인에 쓰는 기본 시간 예산
+    static constexpr std::chrono::microseconds kDefaultDrainBudget{2000};
+
 private:
+    static constexpr size_t kEventRingCapacity = 1024; // 프로젝트별 링 용량
+    static constexpr size_t kGitHeadTag = SIZE_MAX - 1; // .git(HEAD 디렉토리) 구독의 알림 태그 (SIZE_MAX는 수신함 적체 표시)
+
+    // 감시 단위. 앱 정의의 watchRoots 하위 폴더, manifest의 로컬 패키지 폴더(또는 프로젝트 루트 전체)마다 하나.
+    // 커널 감시는 WatchRegistry가 프로젝트 사이에서 공유한다.
+    struct WatchRoot {
+        std::string prefix;   // 알림 경로 앞에 붙일 값: 프로젝트 기준 "Assets/", 외부 패키지면 절대 경로 + '/'
+        bool external;        // 프로젝트 밖 로컬 패키지 (인덱스/프로젝트 무시 규칙 대상 아님)
+        WatchRegistry::SubscriptionId subscription;
+    };
+
     // 감시 중인 프로젝트 정보
     struct WatchedProject {
-        std::string appId;              // 앱 정의 id
-        std::string projectPath;        // 프로젝트 경로 (UTF-8)
-        std::string projectName;        // 프로젝트 이름
-        std::string editorVersion;      // 에디터 버전
+        std::shared_ptr<const ProjectContext> context; // 앱 id/경로/이름/버전 (이벤트와 공유, 불변)
         std::unordered_set<std::string> extensions; // 추적 확장자 (소문자)
-        HANDLE directoryHandle;         // 디렉토리 핸들
+        std::unordered_set<std::string> lineCountExtensions; // 줄 수를 세는 확장자 (소문자)
+        std::string metadataFile;   // 앱 정의의 metadataFile (프로젝트 기준 '/' 경로, 없으면 빈 값)
+        std::shared_ptr<const IgnoreRules> ignoreRules; // 기본 + .gitignore/.wakatimeignore 컴파일 결과
+        std::shared_ptr<const IgnoreRules> packageIgnoreRules; // 외부 로컬 패키지용 기본 규칙만 (프로젝트 규칙은 프로젝트 기준 경로용)
+        std::unique_ptr<FileIndex> fileIndex; // 추적 파일 인덱스 (indexMutex)
+        ContentVerifier contentVerifier;      // 쓰기 이벤트 내용 해시 캐시 (워커 스레드 전용)
+        std::vector<WatchRoot> roots;   // 감시 대상 (Library/Temp 등은 아예 구독하지 않는다)
+        std::shared_ptr<WatchInbox> inbox; // 레지스트리 I/O 스레드 → 감시 스레드 알림
+        WatchRegistry::SubscriptionId gitHeadSubscription; // HEAD 변경 감지용 비재귀 구독 (저장소가 아니면 0)
         std::thread watchThread;        // 감시 스레드
         std::atomic<bool> shouldStop;   // 스레드 종료 플래그
-        OVERLAPPED overlapped;          // 비동기 I/O용 구조체
-        char buffer[Config::FILE_WATCHER_BUFFER_SIZE]; // 변경 정보를 받을 버퍼
         HANDLE stopEvent;
-        HANDLE ioEvent;
+
+        // 인덱스 Refresh는 스캔 스레드에서 돈다. 감시 스레드는 indexMutex를 try_lock만 하고,
+        // 스캔 중이면 인덱스 갱신을 deferredIndexUpdates에 미뤄 두어 이벤트 처리가 스캔에 막히지 않게 한다.
+        std::mutex indexMutex;
+        std::vector<std::pair<std::string, bool>> deferredIndexUpdates; // (상대 경로, 삭제 여부) 워커 스레드 전용
+        std::thread scanThread;
+        std::atomic<bool> scanRunning;
+        std::atomic<bool> rescanRequested;
+        HANDLE scanEvent;                                   // 스캔 결과 도착 (auto-reset)
+        std::mutex scanResultsMutex;
+        std::vector<FileIndex::Change> scanResults;         // scanResultsMutex
+        std::vector<std::string> scanScopes;                // scanResultsMutex, 다음 Refresh 범위 ("" = 프로젝트 전체)
+
+        // 감시 시작 소급(catch-up): 인덱스 저장 시각 ~ 감시 시작 시각 사이에 수정된 파일만 낸다.
+        // 첫 스캔 결과가 오기 전까지 실시간으로 staged한 경로는 소급 이벤트에서 뺀다.
+        uint64_t watchStartTime;                            // FILETIME, 구독 전에 기록 (이후 불변)
+        std::vector<FileIndex::Change> catchUpResults;      // scanResultsMutex
+        bool catchUpReady;                                  // scanResultsMutex, 첫 스캔이 끝났다
+        bool recordingLive;                                 // 워커 스레드 전용
+        std::unordered_set<std::string> livePaths;          // 워커 스레드 전용
+
+        // 코얼레싱 윈도우 동안 경로별 최신 이벤트만 보관 (워커 스레드 전용, 락 불필요)
+        std::vector<FileChangeEvent> stagedEvents;
+        std::unordered_map<std::string, size_t> stagedIndex; // fileName → stagedEvents 인덱스
+        std::chrono::steady_clock::time_point stagedSince;  // 첫 staged 이벤트 시각
+
+        // 감시 스레드 → 메인 스레드 이벤트 링과 backpressure 카운터.
+        // 링이 차면 처리(인덱스 갱신/내용 확인/줄 수)를 마친 이벤트를 readyEvents에 두고 그대로 다시 넣어 본다.
+        SpscRing<FileChangeEvent> eventRing;
+        std::vector<FileChangeEvent> readyEvents;          // 링 자리를 기다리는 처리 완료 이벤트 (시각 순, 워커 스레드 전용)
+        std::chrono::steady_clock::time_point readySince;  // 마지막으로 링이 가득 찼던 시각
+        std::atomic<uint64_t> queuedEvents;   // 링에 넣은 이벤트 수
+        std::atomic<uint64_t> heldBackEvents; // 링이 가득 차 보류한 횟수(이벤트 단위)
+        std::atomic<uint64_t> droppedEvents;  // 보류 한도도 넘어 버린 이벤트 수
+
+        // 임포트 폭주(storm) 감지와 폴더별 샘플링 (워커 스레드 전용, 통계만 atomic)
+        std::chrono::steady_clock::time_point rateWindowStart; // 현재 속도 측정 창 시작
+        size_t rateWindowEvents;                               // 창 안에서 받은 추적 대상 이벤트 수
+        size_t stormQuietWindows;                              // storm 중 연속으로 조용했던 창 수
+        std::chrono::steady_clock::time_point stormNextEmit;   // 다음 샘플 방출 시각
+        std::unordered_map<std::string, FileChangeEvent> stormSamples; // 폴더 → 그 폴더의 최신 이벤트
+        std::atomic<bool> inStorm;
+        std::atomic<uint64_t> stormEntries;   // storm 진입 횟수
+        std::atomic<uint64_t> stormExits;     // storm 해제 횟수
+        std::atomic<uint64_t> sampledOutEvents; // 샘플링으로 대표 이벤트에 흡수된 이벤트 수
 
         WatchedProject() :
-            directoryHandle(INVALID_HANDLE_VALUE),
+            gitHeadSubscription(0),
             shouldStop(false),
             stopEvent(nullptr),
-            ioEvent(nullptr)
+            scanRunning(false),
+            rescanRequested(false),
+            scanEvent(nullptr),
+            watchStartTime(0),
+            catchUpReady(false),
+            recordingLive(true),
+            eventRing(kEventRingCapacity),
+            queuedEvents(0),
+            heldBackEvents(0),
+            droppedEvents(0),
+            rateWindowStart(std::chrono::steady_clock::now()),
+            rateWindowEvents(0),
+            stormQuietWindows(0),
+            inStorm(false),
+            stormEntries(0),
+            stormExits(0),
+            sampledOutEvents(0)
         {
             stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-            ioEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
-            ZeroMemory(&overlapped, sizeof(OVERLAPPED));
-            overlapped.hEvent = ioEvent;
-            ZeroMemory(buffer, sizeof(buffer));
+            scanEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+            inbox = std::make_shared<WatchInbox>();
         }
 
         ~WatchedProject() {
@@ -43,27 +133,27 @@ private:
                 CloseHandle(stopEvent);
                 stopEvent = nullptr;
             }
-            if (ioEvent != nullptr) {
-                CloseHandle(ioEvent);
-                ioEvent = nullptr;
-            }
-            if (directoryHandle != nullptr && directoryHandle != INVALID_HANDLE_VALUE) {
-                CloseHandle(directoryHandle);
-                directoryHandle = INVALID_HANDLE_VALUE;
+            if (scanEvent != nullptr) {
+                CloseHandle(scanEvent);
+                scanEvent = nullptr;
             }
         }
     };
 
+    WatchRegistry watchRegistry; // 프로젝트 간 공유 커널 감시 (감시 스레드보다 오래 살아야 하므로 먼저 선언)
     std::vector<std::unique_ptr<WatchedProject>> watchedProjects;
     mutable std::mutex projectsMutex;  // 스레드 안전성을 위한 뮤텍스
-    std::deque<FileChangeEvent> pendingEvents;
-    mutable std::mutex pendingEventsMutex;
+    std::vector<FileChangeEvent> orphanedEvents; // 감시 중지된 프로젝트 링에 남아 있던 이벤트 (메인 스레드 전용)
     std::atomic<bool> notifyScheduled{false};  // PostMessage 코얼레싱 (큐 적재 통지 1회로 합침)
+    std::atomic<bool> verifyContent{Config::VERIFY_WRITE_CONTENT};
 
-    // 파일 변경 이벤트 콜백 함수
-    std::function<void(const FileChangeEvent&)> changeCallback;
+    // 파일 변경 이벤트 배치 콜백 (드레인 1회당 배치 단위로 호출)
+    ChangeBatchCallback changeCallback;
+    std::vector<FileChangeEvent> drainBatch; // 드레인 배치 버퍼 재사용 (메인 스레드 전용)
     // 큐에 이벤트가 적재되었음을 메인 스레드에 통지 (PostMessage 등)
     std::function<void()> notifyCallback;
+    // 프로젝트 메타데이터 파일(앱 정의의 metadataFile) 변경 통지 (감시 스레드에서 호출)
+    std::function<void(const std::string& projectPath)> metadataCallback;
 
     /**
      * 특정 프로젝트 폴더를 감시하는 워커 스레드 함수
@@ -71,45 +161,126 @@ private:
     void WatchProjectThread(WatchedProject* project);
 
     /**
-     * ReadDirectoryChangesW로부터 받은 데이터를 파싱
+     * ReadDirectoryChangesW로부터 받은 데이터를 파싱 (경로는 root.prefix를 붙여 프로젝트 기준으로 바꾼다)
      */
-    void ProcessFileChanges(char* buffer, DWORD bytesReturned, WatchedProject* project);
+    void ProcessFileChanges(const std::vector<WatchInbox::Notification>& notifications, WatchedProject* project);
 
     /**
-     * ReadDirectoryChangesW 버퍼 오버플로 시 최근 수정된 추적 파일을 합성 이벤트로 적재한다.
+     * 앱 정의의 watchRoots 중 존재하는 폴더와 manifest의 로컬(file:) 패키지 폴더를 레지스트리에 구독한다.
+     * 서로 겹치는 폴더는 바깥 것 하나만 구독한다. 정의가 없거나 존재하는 폴더가 하나도 없으면 프로젝트 루트 전체를 구독한다.
+     * @return 하나 이상 구독했으면 true
      */
-    void QueueSyntheticProjectScan(WatchedProject* project);
+    bool SubscribeWatchRoots(WatchedProject* project, const AppDefinition* def);
 
     /**
-     * 파일 변경 이벤트를 pending 큐에 적재하고 메인 스레드 통지를 예약한다.
+     * 프로젝트의 모든 구독을 해제한다.
      */
-    void QueueFileEvent(WatchedProject* project, const std::string& fileName,
-                        const std::string& fullPath, DWORD action);
+    void UnsubscribeWatchRoots(WatchedProject* project);
 
     /**
-     * 파일이 추적 확장자에 해당하는지 확인
+     * 스캔 스레드에 인덱스 Refresh를 요청한다 (감시 스레드 전용, 실행 중이면 범위만 보태고 1회 더 돌도록 표시).
+     * @param initial 감시 시작 스캔이면 true. 저장된 인덱스를 로드해, 인덱스 저장 이후(추적기가 꺼져 있던 동안)
+     *                수정된 파일을 수정 시각으로 소급한 이벤트로 낸다. 저장된 인덱스가 없으면 이벤트 없이 인덱스만 만든다.
+     * @param scope 다시 볼 디렉토리 (프로젝트 기준 상대 경로). 빈 값이면 프로젝트 전체
      */
-    bool IsTrackedFile(const std::string& fileName, const std::unordered_set<std::string>& extensions) const;
+    void RequestProjectScan(WatchedProject* project, bool initial, const std::string& scope = std::string());
+
+    /**
+     * 스캔 스레드: 요청이 남아 있는 동안 인덱스를 Refresh하고,
+     * 바뀐 추적 파일(최근 수정 순 상위 N개)을 scanResults로 넘긴 뒤 scanEvent로 감시 스레드를 깨운다.
+     */
+    void ScanProjectThread(WatchedProject* project, bool initial);
+
+    /**
+     * scanResults와 소급 결과(catchUpResults)를 합성 이벤트로 적재한다 (감시 스레드 전용).
+     * 소급 결과에서는 그동안 실시간으로 staged한 경로를 뺀다.
+     */
+    void QueueScanResults(WatchedProject* project);
+
+    /**
+     * 미뤄 둔 인덱스 갱신을 반영한다. 스캔이 인덱스를 잡고 있으면 다음 기회로 넘긴다 (감시 스레드 전용).
+     */
+    void SyncFileIndex(WatchedProject* project);
+
+    /**
+     * 파일 변경 이벤트를 경로별로 코얼레싱해 staged 목록에 적재한다 (워커 스레드 전용).
+     * 같은 경로의 이전 이벤트는 최신 action/시각으로 덮어쓴다.
+     * @param relativePath 프로젝트 기준 상대 경로 ('/' 구분자). 전체 경로는 이벤트가 필요할 때 조립한다.
+     * @param timestamp 변경 시각 (실시간 이벤트는 now, 스캔으로 찾은 변경은 파일 수정 시각)
+     */
+    void QueueFileEvent(WatchedProject* project, const std::string& relativePath, DWORD action,
+                        std::chrono::system_clock::time_point timestamp);
+
+    /**
+     * staged 이벤트에서 경로를 제거한다 (rename 쌍의 old name 정리용).
+     */
+    void DropStagedEvent(WatchedProject* project, const std::string& fileName);
+
+    /**
+     * staged 이벤트를 처리해 시각 순으로 프로젝트 링에 넣고 메인 스레드 통지를 1회 예약한다.
+     * 내용 확인이 켜져 있으면 내용이 그대로인 MODIFIED 이벤트는 여기서 버린다 (인덱스 갱신은 그대로).
+     * 링이 가득 차면 남은 이벤트는 readyEvents에 두고 다음 윈도우에 그대로 다시 넣는다
+     * (다른 프로젝트 이벤트를 밀어내지 않고, 인덱스 갱신/내용 확인을 되풀이하지 않음).
+     */
+    void FlushStagedEvents(WatchedProject* project);
+
+    /**
+     * 측정 창이 끝났으면 이벤트 속도로 storm 진입/해제를 판정한다 (워커 스레드 전용).
+     * 해제 시 남은 샘플은 staged로 되돌려 바로 내보낸다.
+     * @return 판정 후 storm 상태이면 true
+     */
+    bool UpdateStormState(WatchedProject* project, std::chrono::steady_clock::time_point now);
+
+    /**
+     * storm 중: staged 이벤트를 폴더별 최신 1건으로 접어 stormSamples에 모은다.
+     */
+    void SampleStagedEvents(WatchedProject* project);
+
+    /**
+     * stagedEvents 순서가 바뀐 뒤 stagedIndex를 다시 만든다.
+     */
+    void RebuildStagedIndex(WatchedProject* project);
 
     /**
-     * 무시해야 할 폴더인지 확인
+     * 감시 스레드가 끝난 프로젝트의 링에 남은 이벤트를 orphanedEvents로 옮긴다 (메인 스레드).
      */
-    bool ShouldIgnoreFolder(const std::string& folderName) const;
+    void CollectOrphanedEvents(WatchedProject* project);
+
+    /**
+     * 코얼레싱 윈도우(storm 중이면 샘플 방출/속도 측정 창, 보류 중이면 링 재시도 포함)가 끝날 때까지 남은 대기 시간(ms).
+     * 기다릴 것이 없으면 INFINITE.
+     */
+    DWORD StagedFlushTimeout(const WatchedProject* project) const;
+
+    /**
+     * 파일이 추적 확장자에 해당하는지 확인
+     */
+    bool IsTrackedFile(const std::string& fileName, const std::unordered_set<std::string>& extensions) const;
 
 public:
     FileWatcher();
     ~FileWatcher();
 
     /**
-     * 파일 변경 이벤트 콜백 함수 설정
+     * 파일 변경 이벤트 배치 콜백 설정. 드레인은 이벤트 1건이 아니라 배치 1개당 1회 호출한다.
      */
-    void SetChangeCallback(std::function<void(const FileChangeEvent&)> callback);
+    void SetChangeCallback(ChangeBatchCallback callback);
 
     /**
      * 큐 적재 통지 콜백 설정 (워커 스레드 → 메인 스레드 마샬링용).
      */
     void SetNotifyCallback(std::function<void()> callback);
 
+    /**
+     * 메타데이터 파일 변경 콜백 설정 (감시 스레드에서 호출되므로 스레드 안전해야 한다). 감시 시작 전에 설정한다.
+     */
+    void SetMetadataCallback(std::function<void(const std::string& projectPath)> callback);
+
+    /**
+     * 쓰기 이벤트 내용 해시 확인 on/off (기본값 Config::VERIFY_WRITE_CONTENT).
+     */
+    void SetContentVerification(bool enabled);
+
     /**
      * 프로젝트 감시 시작.
      * @param appId 앱 정의 id (확장자 필터 조회용)
@@ -137,9 +308,11 @@ public:
     void StopAllWatching();
 
     /**
-     * 워커 스레드에서 수집된 이벤트를 현재(호출) 스레드에서 전달
+     * 프로젝트별 링을 이벤트 시각 순으로 병합해 현재(호출) 스레드에서 배치로 전달한다 (링 읽기는 락 없음).
+     * 예산을 넘기면 남은 이벤트는 통지를 다시 예약해 다음 메시지 루프 회차로 넘긴다.
+     * @param budget 이 호출에서 쓸 최대 시간 (배치 경계에서 확인)
      */
-    void DrainPendingEvents(size_t maxEvents = 1024);
+    void DrainPendingEvents(std::chrono::microseconds budget = kDefaultDrainBudget);
 
     /**
      * 현재 감시 중인 프로젝트 수 반환
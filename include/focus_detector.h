@@ -1,11 +1,15 @@
 #pragma once
 #include "globals.h"
+#include "process_activity_sampler.h"
 
 /**
  * 포그라운드 창 전이/제목 변경 이벤트를 받아, 포커스된 추적 대상 앱의
  * focus heartbeat를 만든다.
  * - DirectoryWatch(Unity): 해당 PID의 실제 프로젝트로 heartbeat (다중 Unity 정확 매핑).
  * - WindowTitle(Aseprite/Blender): 창 제목을 파싱해 활성 파일을 추정.
+ *
+ * 주기 keep-alive는 그 구간에 입력이 있었거나 프로세스가 CPU/읽기 I/O를 썼을 때만 보낸다 (자리를 비운 동안은 끊긴다).
+ * 렌더 중(코어 하나 이상을 계속 사용)이던 인스턴스는 포커스를 잃어도 렌더가 끝날 때까지 keep-alive를 이어간다.
  */
 class FocusDetector {
 public:
@@ -29,6 +33,20 @@ private:
     std::string lastEntity;
     std::string lastProject;
     std::string lastEditorVersion;
+    bool lastRendering = false; // 직전 틱에서 포커스 대상이 렌더 중이었는지
+
+    // 포커스를 떠났지만 렌더 중인 인스턴스 (렌더가 끝나거나 다시 포커스될 때까지 keep-alive)
+    struct RenderTarget {
+        DWORD processId = 0;
+        std::string appId;
+        std::string entity;
+        std::string project;
+        std::string editorVersion;
+    };
+    bool hasRenderTarget = false;
+    RenderTarget renderTarget;
+
+    ProcessActivitySampler activity;
 
     HeartbeatCallback heartbeatCallback;
 
@@ -36,6 +54,17 @@ private:
                        const std::string& project, const std::string& editorVersion);
     void EmitForWindow(HWND hwnd);
     void ClearFocus();
+    void ClearRenderTarget();
+
+    /**
+     * 포커스 대상이 렌더 중이었으면 포커스가 떠나기 전에 렌더 대상으로 넘긴다.
+     */
+    void KeepRenderTarget();
+
+    /**
+     * 렌더 대상이 아직 렌더 중이면 keep-alive를 보내고, 끝났으면 놓는다.
+     */
+    void SendRenderKeepAlive();
 
 public:
     /**
@@ -50,7 +79,7 @@ public:
     void OnTitleChanged(HWND hwnd);
 
     /**
-     * 포커스 유지 중 주기 heartbeat (2분 간격) keep-alive.
+     * 포커스 유지 중 주기 heartbeat (2분 간격) keep-alive. 구간에 활동이 없으면 보내지 않는다.
      */
     void SendPeriodicHeartbeat();
 
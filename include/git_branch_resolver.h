@@ -0,0 +1,59 @@
+#pragma once
+
+#include "globals.h"
+
+/**
+ * 프로젝트의 현재 Git 브랜치 (heartbeat branch 필드용).
+ *
+ * projectPath에서 위로 올라가며 .git을 찾는다. .git이 파일이면(worktree, submodule) "gitdir: <경로>"를 따라간다.
+ * HEAD는 생성/Refresh 때만 읽고 결과를 캐시한다. FileWatcher가 HeadDirectory()를 구독해 HEAD가 바뀔 때 Refresh를 부른다.
+ *
+ * Branch()는 어느 스레드에서나 호출할 수 있다.
+ */
+class GitBranchResolver {
+public:
+    /**
+     * @param projectPath 프로젝트 루트 경로 (UTF-8)
+     */
+    explicit GitBranchResolver(const std::string& projectPath);
+
+    GitBranchResolver(const GitBranchResolver&) = delete;
+    GitBranchResolver& operator=(const GitBranchResolver&) = delete;
+
+    /**
+     * 저장소를 찾았으면 true.
+     */
+    bool IsRepository() const { return !headDirectory.empty(); }
+
+    /**
+     * HEAD 파일이 있는 디렉토리 (worktree면 .git/worktrees/<이름>). 저장소가 아니면 빈 값.
+     */
+    const fs::path& HeadDirectory() const { return headDirectory; }
+
+    /**
+     * 캐시된 브랜치 이름. 저장소가 아니거나 detached HEAD면 빈 값.
+     */
+    std::string Branch() const;
+
+    /**
+     * HEAD를 다시 읽어 캐시를 갱신한다.
+     * @return 브랜치가 바뀌었으면 true
+     */
+    bool Refresh();
+
+private:
+    fs::path headDirectory;
+
+    mutable std::mutex mutex;
+    std::string branch; // mutex
+
+    /**
+     * dir/.git 을 해석해 HEAD가 있는 디렉토리를 찾는다. 없으면 빈 값.
+     */
+    static fs::path ResolveGitDirectory(const fs::path& dir);
+
+    /**
+     * HEAD 내용에서 브랜치 이름을 꺼낸다 ("ref: refs/heads/<이름>"). detached면 빈 값.
+     */
+    static std::string ParseHead(const std::string& content);
+};
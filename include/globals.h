@@ -11,6 +11,7 @@
 #include <windows.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <atomic>
 #include <chrono>
@@ -51,21 +52,50 @@ struct AppInstance
 {
     std::string appId;          // AppRegistry 정의 id
     DWORD processId;
+    uint64_t createTime = 0;    // 프로세스 생성 시각 (FILETIME). PID와 함께 인스턴스를 식별한다 (모르면 0)
     std::string projectPath;    // DirectoryWatch: 감시할 프로젝트 폴더
     std::string projectName;    // 프로젝트/폴더 이름
     std::string editorVersion;  // Unity 에디터 버전 등 (없으면 빈 값)
-    std::string entity;         // WindowTitle 앱의 초기 파일 경로 (커맨드라인에서 추출)
+    std::string entity;         // WindowTitle 앱의 문서 경로 (커맨드라인에서 추출, 이후 열린 파일 핸들로 갱신)
 };
 
-struct FileChangeEvent
+class GitBranchResolver;
+
+/**
+ * 감시 중인 프로젝트의 불변 정보. 감시 시작 시 1회 만들고 그 프로젝트의 모든 이벤트가 공유한다.
+ */
+struct ProjectContext
 {
     std::string appId;
-    std::string filePath;
-    std::string fileName;
-    std::string projectPath;
+    std::string projectPath;   // 감시 시작에 넘어온 경로 그대로 (UTF-8)
     std::string projectName;
-    DWORD action;
+    std::string editorVersion;
+    std::string entityPrefix;  // projectPath를 '/' 구분자로 바꾸고 끝에 '/'를 붙인 것 (FullPath 조립용)
+    std::shared_ptr<GitBranchResolver> git; // 현재 브랜치 캐시 (포인터는 불변, 브랜치는 HEAD 변경 시 갱신)
+};
+
+struct FileChangeEvent
+{
+    std::shared_ptr<const ProjectContext> context;
+    std::string relativePath;  // 프로젝트 기준 상대 경로 ('/' 구분자). 프로젝트 밖 로컬 패키지 파일은 절대 경로
+    DWORD action = 0;
     std::chrono::system_clock::time_point timestamp;
+    int64_t lines = -1;     // 텍스트 에셋의 줄 수 (감시 스레드가 채움), 모르면 -1
+    int64_t lineDelta = 0;  // 직전에 본 내용 대비 줄 수 증감
+
+    /**
+     * 프로젝트 밖(로컬 패키지) 파일이면 true. relativePath가 "C:/…" 또는 "//server/…" 형태다.
+     */
+    bool IsExternal() const
+    {
+        return relativePath.size() >= 2 &&
+               (relativePath[1] == ':' || (relativePath[0] == '/' && relativePath[1] == '/'));
+    }
+
+    /**
+     * heartbeat entity로 쓰는 전체 경로 ('/' 구분자). 필요할 때만 조립한다.
+     */
+    std::string FullPath() const { return IsExternal() ? relativePath : context->entityPrefix + relativePath; }
 };
 
 struct WatchedProjectInfo {
@@ -73,10 +103,22 @@ struct WatchedProjectInfo {
     std::string projectPath;
     std::string projectName;
     std::string editorVersion;
+    size_t pendingEvents = 0;    // 링에서 메인 스레드 처리를 기다리는 이벤트 수
+    uint64_t queuedEvents = 0;   // 누적 링 적재 수
+    uint64_t heldBackEvents = 0; // 링이 가득 차 감시 스레드에 보류된 이벤트 수 (backpressure)
+    uint64_t droppedEvents = 0;  // 보류 한도도 넘어 버려진 이벤트 수
+    bool inStorm = false;           // 임포트 폭주로 폴더별 샘플링 중
+    uint64_t stormEntries = 0;      // storm 진입 횟수
+    uint64_t stormExits = 0;        // storm 해제 횟수
+    uint64_t sampledOutEvents = 0;  // 샘플링으로 흡수된 이벤트 수
+    size_t notifyBufferBytes = 0;   // 감시 root들의 알림 버퍼 합계
+    uint64_t notifyOverflows = 0;   // 알림 버퍼 오버플로 횟수 (공유 감시는 함께 쓰는 프로젝트에 같이 보인다)
+    uint64_t notifyResizes = 0;     // 알림 버퍼 크기 변경 횟수
 };
 
 namespace Config
 {
+    // 기본 무시 폴더 (모든 깊이, 디렉토리 전용 규칙). 프로젝트의 .gitignore/.wakatimeignore 가 뒤에 덧붙는다.
     const std::vector<std::string> IGNORE_FOLDERS = {
         "Library",
         "Temp",
@@ -96,26 +138,14 @@ namespace Config
     const std::string APP_NAME = "creative-wakatime";
     const std::string APP_VERSION = "2.0";
     const int HEARTBEAT_TIMEOUT_MS = 5000;
-    // 대량 import/save 시 ReadDirectoryChangesW 이벤트 유실을 줄이기 위한 큰 버퍼(64KB).
-    const int FILE_WATCHER_BUFFER_SIZE = 65536;
+    // ReadDirectoryChangesW 버퍼: 감시마다 작게 시작해 오버플로 시 키우고, 오래 조용하면 줄인다.
+    // 사용 중인 버퍼 총량은 NOTIFY_BUFFER_TOTAL_CAP을 넘지 않는다 (최소 크기는 항상 허용).
+    const size_t NOTIFY_BUFFER_MIN_SIZE = 4 * 1024;
+    const size_t NOTIFY_BUFFER_MAX_SIZE = 1024 * 1024;
+    const size_t NOTIFY_BUFFER_TOTAL_CAP = 8 * 1024 * 1024;
     const int HEARTBEAT_DEBOUNCE_MS = 2000;
-
-    inline const std::unordered_set<std::string> &GetIgnoreFolders()
-    {
-        static const auto folders = []()
-        {
-            std::unordered_set<std::string> result;
-            for (const auto &folder : IGNORE_FOLDERS)
-            {
-                std::string lower = folder;
-                std::transform(lower.begin(), lower.end(), lower.begin(),
-                               [](const unsigned char c) { return static_cast<char>(::tolower(c)); });
-                result.insert(std::move(lower));
-            }
-            return result;
-        }();
-        return folders;
-    }
+    // 수정 이벤트의 파일 내용을 해시해 내용이 그대로인 재저장(리임포트 등)은 heartbeat로 보내지 않는다.
+    const bool VERIFY_WRITE_CONTENT = true;
 
     /**
      * 앱 데이터 디렉토리 경로 반환 (%APPDATA%/creative-wakatime/).
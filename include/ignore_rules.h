@@ -0,0 +1,143 @@
+#pragma once
+
+#include "globals.h"
+#include <array>
+#include <cstdint>
+#include <map>
+
+/**
+ * 프로젝트별 gitignore 스타일 무시 규칙.
+ * Config::IGNORE_FOLDERS 기본 규칙 + 프로젝트 루트의 .gitignore + .wakatimeignore 를
+ * 한 번 컴파일해 DFA로 만든다. 매칭 비용은 규칙 수와 무관하게 경로 길이에 선형이다.
+ * DFA 상태는 실제 경로가 처음 지나갈 때 만들어 캐시한다 (미리 전부 만들면 규칙 조합만큼 폭증).
+ *
+ * 지원 문법: `#` 주석, `!` 부정, `/` 앵커, 끝 `/`(디렉토리 전용), `*`, `?`, `[...]`, `**`.
+ * 경로는 프로젝트 루트 기준 상대 경로('/' 구분)이며 ASCII 대소문자를 무시한다.
+ * 하위 폴더의 .gitignore 는 읽지 않는다.
+ *
+ * Compile() 이후 IsIgnored()는 여러 스레드에서 동시에 호출해도 안전하다.
+ * 이미 만들어진 전이는 락 없이 읽고, 새 상태를 만들 때만 buildMutex를 잡는다.
+ */
+class IgnoreRules {
+public:
+    /**
+     * 기본 규칙 + 프로젝트 ignore 파일을 읽어 컴파일된 규칙 세트를 만든다.
+     * @param projectPath 프로젝트 루트 경로 (UTF-8)
+     * @return 컴파일 완료된 불변 규칙 세트 (파일이 없어도 기본 규칙은 포함)
+     */
+    static std::shared_ptr<const IgnoreRules> LoadForProject(const std::string& projectPath);
+
+    /**
+     * 기본 규칙(Config::IGNORE_FOLDERS)만 담은 규칙 세트. 프로젝트 밖 폴더(로컬 패키지)에 쓴다.
+     * 처음 호출할 때 한 번 컴파일하고 이후에는 같은 세트를 공유한다.
+     */
+    static std::shared_ptr<const IgnoreRules> Defaults();
+
+    /**
+     * gitignore 한 줄을 규칙으로 추가한다. 빈 줄/주석은 무시. Compile() 전에만 호출.
+     */
+    void AddPattern(const std::string& line);
+
+    /**
+     * ignore 파일 전체를 읽어 규칙으로 추가한다. 파일이 없으면 false.
+     */
+    bool AddPatternsFromFile(const fs::path& filePath);
+
+    /**
+     * 추가된 규칙을 DFA로 컴파일한다.
+     */
+    void Compile();
+
+    /**
+     * 상대 경로가 무시 대상인지 확인. 상위 디렉토리가 무시되면 하위도 무시된다 (git과 동일).
+     * @param relativePath 프로젝트 루트 기준 상대 경로 ('/' 구분, 앞뒤 '/' 없음)
+     * @param isDirectory 경로 자체가 디렉토리이면 true (디렉토리 전용 규칙 적용)
+     */
+    bool IsIgnored(const std::string& relativePath, bool isDirectory) const;
+
+    /**
+     * 컴파일된 규칙 수.
+     */
+    size_t RuleCount() const { return rules.size(); }
+
+private:
+    // NFA 위치 하나: (rule << 16) | (pos << 1) | sub
+    using Item = uint32_t;
+
+    struct Token {
+        enum Kind : uint8_t {
+            Literal,  // 문자 1개
+            AnyChar,  // ? : '/' 제외 1글자
+            Star,     // * : '/' 제외 0글자 이상
+            DirStar,  // **/ : 0개 이상의 디렉토리 접두
+            AnyRun,   // 끝의 /** : 1글자 이상 전부
+            Class     // [...]
+        };
+        Kind kind;
+        unsigned char ch;   // Literal 문자 (소문자)
+        uint16_t classId;   // Class 인덱스
+    };
+
+    struct Rule {
+        std::vector<Token> tokens;
+        bool negate = false;    // '!' 규칙
+        bool dirOnly = false;   // 끝 '/' 규칙
+    };
+
+    struct StateInfo {
+        int32_t matchAny = -1;  // 이 상태에서 매치된 마지막 규칙 (디렉토리 판정용)
+        int32_t matchFile = -1; // 디렉토리 전용 규칙을 뺀 마지막 규칙 (파일 판정용)
+    };
+
+    // 상태 블록: 전이 테이블과 상태 정보를 블록 단위로 할당해 이미 공개된 상태의 주소가 바뀌지 않게 한다.
+    static constexpr size_t kStatesPerBlock = 64;
+    struct DfaBlock {
+        std::array<StateInfo, kStatesPerBlock> info;
+        std::array<std::vector<Item>, kStatesPerBlock> items;      // 상태 → NFA 위치 집합
+        std::unique_ptr<std::atomic<int32_t>[]> next;              // (state, class) → 다음 state
+    };
+
+    static constexpr Item kSegmentStart = 0xFFFFFFFF; // "모든 깊이" 규칙이 새로 시작할 수 있는 위치 표식
+    static constexpr Item kAwaitSegment = 0xFFFFFFFE; // 세그먼트 안: 다음 '/' 뒤에 "모든 깊이" 규칙이 다시 시작된다
+    static constexpr int32_t kDeadState = -1;    // 더 이상 어떤 규칙도 매치 불가 ("모든 깊이" 규칙이 없을 때만)
+    static constexpr int32_t kUnbuiltState = -2; // 아직 만들지 않은 전이
+
+    std::vector<Rule> rules;
+    std::vector<std::array<bool, 256>> charClasses;
+    bool compiled = false;
+
+    // 입력 압축 (Compile 이후 불변)
+    std::array<uint8_t, 256> byteClass{};   // 바이트 → 입력 클래스 (대소문자 접힘 포함)
+    std::vector<unsigned char> classSample; // 입력 클래스 → 대표 바이트
+    std::vector<std::vector<Item>> segmentStartSteps; // 클래스 → 세그먼트 시작에서 진입하는 위치
+    StateInfo segmentStartAccept;
+    bool hasUnanchored = false;
+
+    // 지연 생성 DFA. blocks는 Compile에서 크기를 고정하고 원소만 buildMutex 아래에서 채운다.
+    mutable std::vector<std::unique_ptr<DfaBlock>> blocks;
+    mutable std::mutex buildMutex;
+    mutable std::map<std::vector<Item>, int32_t> stateIds; // buildMutex
+    mutable size_t stateCount = 0;                          // buildMutex
+
+    bool ParseRule(const std::string& pattern, Rule& rule);
+    bool IsUnanchored(uint32_t ruleIndex) const;
+    void Closure(std::vector<Item>& items) const;
+    void Advance(const std::vector<Item>& items, unsigned char byte, std::vector<Item>& out) const;
+    std::vector<Item> Step(const std::vector<Item>& items, unsigned char byte) const;
+    StateInfo Accepting(const std::vector<Item>& items) const;
+    bool IsIgnoredSlow(const std::string& relativePath, size_t offset,
+                       std::vector<Item> items, bool isDirectory) const;
+    bool IsIgnoredBy(int32_t ruleIndex) const;
+
+    std::atomic<int32_t>& NextSlot(int32_t state, uint8_t inputClass) const;
+    const DfaBlock& BlockOf(int32_t state) const;
+    int32_t AddState(std::vector<Item> items) const;
+    int32_t BuildTransition(int32_t state, uint8_t inputClass) const;
+
+#ifndef NDEBUG
+    /**
+     * 고정 예제 경로로 DFA 결과를 기대값·NFA 시뮬레이션(IsIgnoredSlow)과 대조한다 (디버그 빌드, 불일치는 WT_ERR).
+     */
+    static void SelfCheck();
+#endif
+};
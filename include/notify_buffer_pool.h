@@ -0,0 +1,96 @@
+#pragma once
+
+#include "globals.h"
+#include <unordered_map>
+
+/**
+ * ReadDirectoryChangesW 버퍼 풀.
+ * 크기는 2의 거듭제곱(minSize~maxSize)으로 맞추고, 빌려준 버퍼와 보관 중인 버퍼의 합이 totalCap을 넘지 않게 한다.
+ * 반환된 버퍼는 크기별로 조금씩 보관했다가 다음 확장/축소 때 재사용한다 (상한이 모자라면 보관분부터 버린다). 스레드 안전.
+ */
+class NotifyBufferPool {
+public:
+    /**
+     * 빌린 버퍼. 소멸하면 풀로 돌아간다 (풀보다 먼저 소멸해야 한다).
+     */
+    class Buffer {
+    public:
+        Buffer() = default;
+        ~Buffer() { Reset(); }
+
+        Buffer(Buffer&& other) noexcept :
+            owner(std::exchange(other.owner, nullptr)),
+            storage(std::move(other.storage)),
+            size(std::exchange(other.size, 0))
+        {
+        }
+
+        Buffer& operator=(Buffer&& other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                owner = std::exchange(other.owner, nullptr);
+                storage = std::move(other.storage);
+                size = std::exchange(other.size, 0);
+            }
+            return *this;
+        }
+
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        char* Data() const { return reinterpret_cast<char*>(storage.get()); }
+        size_t Size() const { return size; }
+        explicit operator bool() const { return storage != nullptr; }
+
+    private:
+        friend class NotifyBufferPool;
+
+        NotifyBufferPool* owner = nullptr;
+        std::unique_ptr<DWORD[]> storage; // FILE_NOTIFY_INFORMATION은 DWORD 정렬이어야 한다
+        size_t size = 0;
+
+        void Reset()
+        {
+            if (owner != nullptr && storage != nullptr) owner->Return(std::move(storage), size);
+            owner = nullptr;
+            storage.reset();
+            size = 0;
+        }
+    };
+
+    NotifyBufferPool(size_t minSize, size_t maxSize, size_t totalCap);
+
+    NotifyBufferPool(const NotifyBufferPool&) = delete;
+    NotifyBufferPool& operator=(const NotifyBufferPool&) = delete;
+
+    /**
+     * size 이상인 가장 작은 크기(2의 거듭제곱, maxSize 이하)로 빌려준다.
+     * 총량 상한에 걸리면 보관 버퍼를 버려 자리를 만들고, 그래도 모자라면 들어가는 가장 큰 크기로 줄인다.
+     * 그래도 안 되면 minSize를 준다.
+     */
+    Buffer Acquire(size_t size);
+
+    size_t MinSize() const { return minSize; }
+    size_t MaxSize() const { return maxSize; }
+
+    /**
+     * 현재 빌려준 버퍼 총량 (바이트).
+     */
+    size_t BytesInUse() const;
+
+private:
+    static constexpr size_t kMaxFreePerSize = 2; // 크기별 보관 개수
+
+    const size_t minSize;
+    const size_t maxSize;
+    const size_t totalCap;
+
+    mutable std::mutex mutex;
+    size_t bytesInUse = 0;                                                     // mutex
+    size_t bytesRetained = 0;                                                  // 보관 중인 버퍼 총량 (mutex)
+    std::unordered_map<size_t, std::vector<std::unique_ptr<DWORD[]>>> freeLists; // 크기 → 보관 버퍼 (mutex)
+
+    void Return(std::unique_ptr<DWORD[]> storage, size_t size);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "globals.h"
+#include <unordered_map>
+
+/**
+ * WindowTitle 앱(Aseprite/Blender)이 열어 둔 문서 파일을 프로세스 핸들 테이블에서 찾는다.
+ *
+ * NtQueryInformationProcess(ProcessHandleInformation)로 핸들 목록을 한 번에 받아 직전 목록과 비교하고,
+ * 새로 생긴 핸들만 복제해 경로를 읽는다. 디스크 파일(FILE_TYPE_DISK)만 경로를 조회한다
+ * (파이프는 경로 조회가 멈출 수 있다). 파일 객체 타입 번호를 한 번 알아내면 다른 타입 핸들은 복제하지 않는다.
+ *
+ * 핸들 값은 닫힌 자리를 다시 쓰므로 열린 순서를 알려 주지 않는다. 그래서 창 제목의 파일 이름과 같은 핸들을 우선하고,
+ * 제목으로 못 고르면 이번 스캔에 새로 생긴 후보가 하나일 때만 채택한다 (첫 스캔처럼 여러 개면 추측하지 않는다).
+ *
+ * 인스턴스마다 kMinScanInterval에 한 번만 스캔한다. 메인 스레드 전용.
+ */
+class OpenFileResolver {
+public:
+    /**
+     * 열어 둔 문서 파일의 전체 경로 (UTF-8). 찾은 적이 없으면 빈 값.
+     * 스캔 주기 안이면 다시 스캔하지 않고, 지난 스캔의 핸들 중 제목과 맞는 것이 있으면 그것을 돌려준다.
+     * @param createTime 프로세스 생성 시각 (PID 재사용 확인, 모르면 0)
+     * @param extensions 문서 확장자 (".blend", 대소문자 무시). 비어 있으면 디스크 파일 전부
+     * @param titleName 창 제목에서 읽은 파일 이름 (경로 없이, 모르면 빈 값)
+     */
+    std::string Resolve(DWORD pid, uint64_t createTime, const std::vector<std::string>& extensions,
+                        const std::string& titleName);
+
+    /**
+     * 인스턴스 상태를 버린다 (추적 종료 시).
+     */
+    void Forget(DWORD pid);
+
+private:
+    static constexpr std::chrono::seconds kMinScanInterval{15};
+    // 한 번의 스캔에서 복제해 볼 새 핸들 상한 (첫 스캔에서 핸들 수천 개를 다 열지 않도록)
+    static constexpr size_t kMaxProbesPerScan = 2048;
+
+    struct State {
+        uint64_t createTime = 0;
+        bool scanned = false;
+        std::chrono::steady_clock::time_point lastScan;
+        // 직전 스캔의 핸들 값 → 확장자가 맞는 디스크 파일 경로 (아니면 빈 값)
+        std::unordered_map<ULONG_PTR, std::wstring> handles;
+        std::string latest; // 마지막으로 고른 문서 경로
+    };
+
+    std::unordered_map<DWORD, State> states;
+    std::vector<unsigned char> snapshotBuffer; // 핸들 목록 조회 버퍼 (재사용)
+    bool fileTypeKnown = false;
+    ULONG fileTypeIndex = 0;                   // 파일 객체의 ObjectTypeIndex (부팅마다 고정)
+
+    /**
+     * 핸들 목록을 받아 state.handles와 비교하고 새 핸들만 경로를 읽는다.
+     * 제목과 이름이 같은 핸들, 없으면 유일한 새 후보를 state.latest에 넣는다 (새 후보가 여럿이면 그대로 둔다).
+     */
+    void Scan(DWORD pid, State& state, const std::vector<std::string>& extensions, const std::wstring& titleName);
+
+    /**
+     * state.handles 중 파일 이름이 titleName과 같은(대소문자 무시) 경로. 없으면 nullptr.
+     */
+    static const std::wstring* FindTitled(const State& state, const std::wstring& titleName);
+
+    /**
+     * 대상 프로세스의 핸들을 복제해 디스크 파일이면 경로를 돌려준다. 아니면 빈 값.
+     */
+    std::wstring ProbeHandle(HANDLE process, HANDLE handle, ULONG typeIndex);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "globals.h"
+#include <unordered_map>
+
+/**
+ * 한 샘플 구간의 프로세스 활동.
+ */
+struct ProcessActivity {
+    bool known = false;     // 기준 샘플이 있고 구간이 충분히 길었으면 true (아니면 나머지 값은 의미 없음)
+    double cpuCores = 0.0;  // 구간 평균 CPU 사용량 (코어 단위, 1.0 = 코어 하나를 계속 사용)
+    uint64_t readBytes = 0; // 구간 읽기 I/O 바이트
+    bool active = false;    // CPU나 읽기 I/O가 유휴 수준을 넘었다
+    bool rendering = false; // 코어 하나 이상을 구간 내내 쓰고 있다 (렌더/베이크 등 긴 계산)
+};
+
+/**
+ * 추적 중인 프로세스의 CPU 시간/I/O 카운터를 구간 단위로 비교한다 (주기 heartbeat 틱마다 1회, 포커스 대상만).
+ * 샘플 1회 = OpenProcess + GetProcessTimes + GetProcessIoCounters.
+ *
+ * 쓰기 I/O는 보지 않는다. 자동 저장처럼 사용자가 없어도 주기적으로 쓰기 때문이다.
+ * PID마다 기준점(생성 시각 포함)을 보관하므로 PID가 재사용되면 기준점을 새로 잡는다.
+ * 메인 스레드 전용.
+ */
+class ProcessActivitySampler {
+public:
+    /**
+     * 직전 샘플 이후의 활동을 계산하고 기준점을 지금으로 옮긴다.
+     * 첫 샘플이거나 구간이 kMinWindow보다 짧으면 known=false.
+     */
+    ProcessActivity Sample(DWORD pid);
+
+    /**
+     * 기준점을 지금으로 잡는다 (포커스를 막 받은 프로세스).
+     */
+    void Reset(DWORD pid);
+
+    /**
+     * 기준점을 버린다.
+     */
+    void Forget(DWORD pid);
+
+private:
+    // 유휴 판정 기준: 코어 하나의 2% (2분 구간이면 CPU 2.4초), 읽기 1MB
+    static constexpr double kActiveCpuCores = 0.02;
+    static constexpr uint64_t kActiveReadBytes = 1024 * 1024;
+    // 렌더 판정 기준: 구간 평균 코어 0.9개 이상. GPU 렌더도 코어 하나는 계속 쓰고, 유휴 UI는 이만큼 오래 쓰지 않는다.
+    static constexpr double kRenderCpuCores = 0.9;
+    static constexpr std::chrono::seconds kMinWindow{10};
+    static constexpr size_t kMaxBaselines = 64;
+
+    struct Counters {
+        uint64_t createTime = 0; // FILETIME (PID 재사용 확인)
+        uint64_t cpuTime = 0;    // 커널 + 사용자 시간 (100ns 단위)
+        uint64_t readBytes = 0;
+    };
+
+    struct Baseline {
+        Counters counters;
+        std::chrono::steady_clock::time_point at;
+    };
+
+    std::unordered_map<DWORD, Baseline> baselines;
+
+    /**
+     * 현재 카운터를 읽는다. 프로세스를 열 수 없으면 false.
+     */
+    static bool ReadCounters(DWORD pid, Counters& counters);
+};
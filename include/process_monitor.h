@@ -2,25 +2,229 @@
 
 #include "globals.h"
 #include "app_registry.h"
+#include "project_metadata_cache.h"
+#include "open_file_resolver.h"
+#include <condition_variable>
+#include <deque>
 #include <unordered_map>
 #include <unordered_set>
 
 /**
- * 활성화된 앱들의 프로세스를 스냅샷으로 감지하고 AppInstance로 해석한다.
+ * 보조 스캔 통계 (트레이 상태 표시용).
+ */
+struct ProcessScanStats {
+    uint64_t wakeups = 0;        // PollChanges 호출 수
+    uint64_t fullScans = 0;      // 프로세스 목록 스냅샷을 뜬 횟수
+    uint64_t livenessChecks = 0; // 추적 중인 핸들만 확인한 횟수
+    uint64_t scanMicros = 0;     // PollChanges에 쓴 누적 시간 (µs)
+    uint32_t intervalMs = 0;     // 현재 스캔 주기
+};
+
+/**
+ * 활성화된 앱들의 프로세스를 감지하고 AppInstance로 해석한다.
  * Unity는 커맨드라인 -projectPath, Aseprite/Blender는 positional 파일 인자(hybrid)로
  * 초기 entity를 확보한다.
+ *
+ * 시작/종료는 이벤트로 받는다. 시작은 최상위 창 표시(OnWindowShown), 종료는 인스턴스마다 프로세스 핸들을
+ * RegisterWaitForSingleObject로 기다려 스레드 풀에서 통지한다. PollChanges 스냅샷은 놓친 변화를 메우는 보조 경로다.
+ * 보조 스캔 주기는 변화가 없으면 두 배씩 늘고(상한 kScanMaxIntervalMs), 새 포그라운드 PID/앱 토글/트레이 조작 때
+ * 하한으로 당겨진다. 활성 앱마다 살아 있는 인스턴스가 있으면 스냅샷 대신 추적 핸들만 확인한다.
+ *
+ * 같은 스냅샷의 부모 PID로 보조 프로세스(Unity AssetImportWorker/라이선스 클라이언트, Blender 렌더 서브프로세스 등)를
+ * 루트 인스턴스에 묶는다 (helperRoots). 루트 앱의 exe(processNames/helperProcessNames)만 묶고, 에디터가 띄운 IDE나
+ * 브라우저처럼 다른 exe인 자손은 묶지 않는다. 보조 프로세스는 따로 해석하지 않고 포커스 시 루트 인스턴스로 바로 매핑된다.
+ *
+ * 해석(커맨드 라인 읽기, 프로젝트 검증)은 해석 워커 스레드에서 한다. 메인 스레드는 PID를 대기 상태(pendingPids)로
+ * 올려두고 바로 돌아가며, 결과는 lifecycle 통지 후 CollectResolved로 받는다.
+ * 공개 메서드는 메인 스레드(메시지 펌프)에서만 호출한다.
  */
 class ProcessMonitor {
 private:
+    // 종료 대기 등록. 콜백 컨텍스트로 넘기므로 주소가 고정되도록 unique_ptr로 보관한다.
+    struct ExitWatch {
+        ProcessMonitor* owner;
+        DWORD pid;
+        HANDLE process;
+        HANDLE wait;
+    };
+
+    // 창 표시 훅에서 이미 확인한(추적 대상이 아닌) PID 상한. 넘으면 비운다.
+    static constexpr size_t kMaxCheckedPids = 4096;
+    // 해석 실패 캐시 상한. 보조 스캔마다 사라진 프로세스를 빼고, 그래도 넘으면 비운다.
+    static constexpr size_t kMaxUnresolved = 1024;
+    // 해석 워커 수. 에디터 여러 개가 함께 떠도 파일 시스템 검사가 줄줄이 밀리지 않을 만큼만.
+    static constexpr size_t kResolverThreads = 2;
+    // 보조 스캔 주기 하한/상한
+    static constexpr uint32_t kScanMinIntervalMs = 10000;
+    static constexpr uint32_t kScanMaxIntervalMs = 600000;
+    // 보조 프로세스 → 루트 탐색 깊이, 색인 상한
+    static constexpr size_t kMaxTreeDepth = 8;
+    static constexpr size_t kMaxHelpers = 1024;
+
+    // 스냅샷의 프로세스 트리 노드
+    struct ProcessNode {
+        DWORD parent = 0;
+        uint64_t createTime = 0;
+        const AppDefinition* app = nullptr; // exe가 보조 프로세스로 묶일 수 있는 앱 (AppRegistry::FindByHelperName)
+    };
+
+    // 보조 프로세스 → 루트 인스턴스
+    struct HelperLink {
+        DWORD root = 0;          // activeInstances(또는 해석 중인) 루트 PID
+        uint64_t createTime = 0; // 보조 프로세스 생성 시각 (PID 재사용 확인, 모르면 0)
+    };
+
+    // 해석 작업 (메인 스레드 → 워커)
+    struct ResolveJob {
+        DWORD pid = 0;
+        uint64_t createTime = 0;        // 제출 시점의 생성 시각, 모르면 0
+        const AppDefinition* def = nullptr;
+    };
+
+    // 해석 결과 (워커 → 메인 스레드). instance의 appId/processId/createTime은 실패해도 채워진다.
+    struct ResolveResult {
+        bool resolved = false;
+        AppInstance instance;
+    };
+
     std::unordered_map<DWORD, AppInstance> activeInstances;
+    ProjectMetadataCache projectMetadata; // Unity 프로젝트 유효성/버전/이름
+    OpenFileResolver openFiles;           // WindowTitle 앱이 열어 둔 문서 (핸들 테이블)
+    std::unordered_map<DWORD, std::unique_ptr<ExitWatch>> exitWatches; // activeInstances와 같은 키
+    std::unordered_set<DWORD> checkedPids; // 창 표시 훅 negative 캐시 (보조 스캔마다 비움)
+    // 추적 앱 exe지만 해석에 실패한 프로세스: PID → 생성 시각(FILETIME). 같은 프로세스는 다시 해석하지 않는다.
+    // 생성 시각이 다르면 PID가 재사용된 다른 프로세스다.
+    std::unordered_map<DWORD, uint64_t> unresolved;
+    std::unordered_set<DWORD> pendingPids; // 해석 중인 PID (메인 스레드). 결과가 올 때까지 다시 제출하지 않는다.
+    std::unordered_map<DWORD, HelperLink> helperRoots; // 보조 프로세스 색인 (전체 스냅샷마다 다시 만든다)
+
+    std::mutex exitedMutex;
+    std::vector<DWORD> exitedPids;          // 스레드 풀 → 메인 스레드 (exitedMutex)
+    std::vector<AppInstance> staleInstances; // PID 재사용으로 밀려난 인스턴스, 다음 CollectExited에서 보고 (메인 스레드)
+    std::function<void()> lifecycleNotify;  // 종료/해석 완료 통지 (스레드 풀, 해석 워커에서 호출)
+
+    std::mutex resolveMutex;
+    std::condition_variable resolveCv;
+    std::deque<ResolveJob> resolveJobs;        // resolveMutex
+    std::vector<ResolveResult> resolveResults; // resolveMutex
+    bool resolverStopping = false;             // resolveMutex
+    std::vector<std::thread> resolverThreads;
+
+    uint32_t scanIntervalMs = kScanMinIntervalMs;
+    ProcessScanStats scanStats;
+    std::unordered_set<DWORD> seenForegroundPids;          // 주기를 이미 당긴 포그라운드 PID (상한 kMaxCheckedPids)
+    std::function<void(uint32_t)> scanIntervalCallback;   // 주기 변경 통지 (메인 스레드)
 
     /**
-     * NtQueryInformationProcess + PEB 읽기로 프로세스 커맨드 라인을 가져온다.
-     * (PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ 권한 필요, 64-bit 전제)
+     * 스캔 주기를 바꾸고, 달라졌으면 콜백으로 알린다.
+     */
+    void SetScanInterval(uint32_t intervalMs);
+
+    /**
+     * 활성 앱마다 살아 있는 인스턴스가 하나 이상 있는지 (이때 새 인스턴스는 창 표시 훅이 잡는다).
+     */
+    bool AllEnabledAppsLive() const;
+
+    /**
+     * 스냅샷 diff: 종료를 closed에 넣고 새 프로세스를 해석 워커에 넘긴다.
+     * @return 종료나 새 프로세스가 있었으면 true
+     */
+    bool ScanSnapshot(std::vector<AppInstance>& closed);
+
+    /**
+     * 추적 중이거나 해석 중인 루트 PID인지.
+     */
+    bool IsRootPid(DWORD pid) const;
+
+    /**
+     * 트리를 따라 올라가 가장 가까운 루트 PID를 찾는다 (kMaxTreeDepth까지). 없으면 0.
+     * 시작 프로세스부터 루트까지 모두 같은 앱의 exe여야 한다 (다른 exe를 만나면 끊는다).
+     * 자식보다 늦게 생성된 부모는 PID가 재사용된 다른 프로세스이므로 거기서 끊는다.
+     */
+    DWORD FindTreeRoot(DWORD pid, const std::unordered_map<DWORD, ProcessNode>& tree) const;
+
+    /**
+     * 스냅샷 트리로 helperRoots를 다시 만든다.
+     */
+    void IndexHelpers(const std::unordered_map<DWORD, ProcessNode>& tree);
+
+    /**
+     * 보조 프로세스면 루트 인스턴스. 색인에 없으면 부모 한 단계만 조회해 색인에 추가한다 (커맨드 라인은 읽지 않는다).
+     * @param exe pid의 exe 이름. 루트 앱의 exe가 아니면 색인에 없는 프로세스는 묶지 않는다 (모르면 빈 값)
+     */
+    const AppInstance* FindHelperRoot(DWORD pid, std::wstring_view exe);
+
+    /**
+     * 부모 프로세스 ID (ProcessBasicInformation). 알 수 없으면 0.
+     */
+    static DWORD GetParentProcessId(DWORD pid);
+
+    /**
+     * 추적 중인 인스턴스만 살아 있는지 확인한다 (프로세스 목록을 뜨지 않는다).
+     */
+    void CheckLiveness(std::vector<AppInstance>& closed);
+
+    /**
+     * 인스턴스를 등록하고 종료 대기를 건다. 대기를 걸 수 없으면 보조 스캔이 종료를 잡는다.
+     */
+    void Track(const AppInstance& instance);
+
+    /**
+     * 인스턴스를 제거하고 종료 대기를 해제한다 (진행 중인 콜백이 끝날 때까지 기다린다).
+     */
+    void Untrack(DWORD pid);
+
+    /**
+     * 등록된 인스턴스의 프로세스가 이미 끝났는지 (같은 PID가 다른 프로세스로 재사용됐을 수 있음).
+     * 종료 대기 핸들이 있으면 그 핸들의 신호 상태로, 없으면 생성 시각 비교로 판단한다.
+     */
+    bool IsStale(DWORD pid, const AppInstance& instance) const;
+
+    /**
+     * 밀려난 인스턴스를 제거하고 종료로 보고되도록 staleInstances에 넣는다.
+     */
+    void RetireStale(DWORD pid);
+
+    /**
+     * 스레드 풀 대기 콜백: 종료된 PID를 적재하고 메인 스레드에 통지한다.
+     */
+    static void CALLBACK OnProcessExited(PVOID context, BOOLEAN timedOut);
+
+    std::vector<unsigned char> snapshotBuffer; // 프로세스 목록 조회 버퍼 (재사용)
+
+    /**
+     * 전체 프로세스의 (PID, exe 이름, 생성 시각, 부모 PID)를 순회한다 (생성 시각을 모르면 0).
+     * NtQuerySystemInformation으로 한 번에 받고, 실패하면 Toolhelp 스냅샷으로 대신한다. 이름 view는 콜백 안에서만 유효하다.
+     * @return 목록을 얻었으면 true
+     */
+    bool ForEachProcess(const std::function<void(DWORD, std::wstring_view, uint64_t, DWORD)>& visit);
+
+    /**
+     * 프로세스 생성 시각 (FILETIME, 100ns 단위). 알 수 없으면 0.
+     */
+    static uint64_t GetProcessCreateTime(DWORD pid);
+
+    /**
+     * 해석 워커에 PID를 넘기고 대기 상태로 올린다. 이미 추적/대기 중이거나,
+     * 같은 (PID, 생성 시각)이 한 번 실패했으면 제출하지 않는다.
+     * @param createTime 알고 있으면 생성 시각, 0이면 여기서 조회한다 (조회 실패 시 실패 캐시를 쓰지 않는다)
+     * @return 제출했으면 true
+     */
+    bool SubmitResolve(DWORD pid, uint64_t createTime, const AppDefinition& def);
+
+    /**
+     * 해석 워커 루프: 작업을 꺼내 ResolveInstance를 돌리고 결과를 적재한 뒤 메인 스레드에 통지한다.
+     */
+    void ResolverThreadFunction();
+
+    /**
+     * 프로세스 커맨드 라인을 가져온다. NtQueryInformationProcess(ProcessCommandLineInformation)를 먼저 쓰고,
+     * 지원하지 않는 OS에서는 PEB를 읽는다 (PROCESS_VM_READ 권한 필요, 64-bit 전제).
+     * 해석 워커마다 조회 버퍼를 따로 재사용한다.
      * @param pid 대상 프로세스 ID
      * @return 커맨드 라인, 실패시 빈 문자열
      */
-    std::string GetCommandLineViaPeb(DWORD pid);
+    static std::string ReadCommandLine(DWORD pid);
 
     /**
      * 프로세스의 실행 파일 이름(예: "blender.exe")을 가져온다.
@@ -30,7 +234,7 @@ private:
     std::wstring GetProcessExeName(DWORD pid);
 
     /**
-     * 주어진 정의/PID로 AppInstance를 해석한다.
+     * 주어진 정의/PID로 AppInstance를 해석한다 (해석 워커에서 호출, 멤버 상태는 projectMetadata만 건드린다).
      * DirectoryWatch(Unity): 프로젝트 경로 검증 실패 시 false.
      * WindowTitle(Aseprite/Blender): 프로세스 존재만으로 true(entity는 선택적).
      * @param pid 대상 프로세스 ID
@@ -81,24 +285,82 @@ public:
     ~ProcessMonitor();
 
     /**
-     * 현재 실행 중인 활성 앱 인스턴스를 전부 스캔 (초기 스캔용).
-     * 결과를 activeInstances에 등록하여 이후 PollChanges가 중복 보고하지 않도록 한다.
-     * @return 발견된 인스턴스들
+     * 현재 실행 중인 활성 앱 프로세스를 전부 해석 워커에 넘긴다 (초기 스캔용).
+     * 대기 상태로 올려두므로 이후 PollChanges가 중복 제출하지 않는다. 결과는 CollectResolved로 받는다.
+     * @return 제출한 프로세스 수
      */
-    std::vector<AppInstance> ScanProcesses();
+    size_t ScanProcesses();
 
     /**
-     * 단일 스냅샷으로 새로 시작/종료된 인스턴스를 diff한다.
-     * 활성 앱의 프로세스 이름만 매칭하고, 알려진 PID는 재해석하지 않는다.
-     * @param started 새로 감지된 인스턴스 (출력)
+     * 보조 스캔 1회. 단일 스냅샷으로 종료된 인스턴스를 diff하고, 새로 등장한 활성 앱 프로세스를 해석 워커에 넘긴다.
+     * 활성 앱의 프로세스 이름만 매칭하고, 알려진/대기 중인 PID는 다시 제출하지 않는다.
+     * 활성 앱이 모두 살아 있으면 추적 핸들만 확인한다. 결과에 따라 다음 스캔 주기를 정한다.
+     * @param closed 종료된 인스턴스 (출력)
+     */
+    void PollChanges(std::vector<AppInstance>& closed);
+
+    /**
+     * 현재 보조 스캔 주기 (ms).
+     */
+    uint32_t GetScanIntervalMs() const { return scanIntervalMs; }
+
+    /**
+     * 스캔 주기를 하한으로 당긴다 (앱 토글, 트레이 조작처럼 곧 변화가 있을 만한 때).
+     */
+    void TightenScan();
+
+    /**
+     * 스캔 주기 변경 콜백 설정 (메인 스레드에서 호출된다, 타이머 재설정용).
+     */
+    void SetScanIntervalCallback(const std::function<void(uint32_t)>& callback);
+
+    /**
+     * 보조 스캔 통계.
+     */
+    ProcessScanStats GetScanStats() const;
+
+    /**
+     * 종료/해석 완료 통지 콜백 설정. 스레드 풀과 해석 워커에서 호출되므로 메인 스레드로 메시지를 post하는 정도만 해야 한다.
+     * 첫 해석을 제출하기 전에 설정한다.
+     */
+    void SetLifecycleCallback(const std::function<void()>& callback);
+
+    /**
+     * 종료 대기로 통지된 인스턴스를 꺼낸다 (통지 메시지를 받은 메인 스레드에서 호출).
      * @param closed 종료된 인스턴스 (출력)
      */
-    void PollChanges(std::vector<AppInstance>& started, std::vector<AppInstance>& closed);
+    void CollectExited(std::vector<AppInstance>& closed);
+
+    /**
+     * 해석 워커가 끝낸 인스턴스를 등록하고 꺼낸다 (통지 메시지를 받은 메인 스레드에서 호출).
+     * 해석 중에 종료됐거나 앱이 꺼진 결과는 버리고, 실패는 실패 캐시에 남긴다.
+     * @param started 새로 감지된 인스턴스 (출력)
+     */
+    void CollectResolved(std::vector<AppInstance>& started);
+
+    /**
+     * 프로젝트 메타데이터 캐시 항목을 버린다 (아무 스레드에서나 호출 가능, FileWatcher 감시 스레드가 호출).
+     */
+    void InvalidateProjectMetadata(const std::string& projectPath);
+
+    /**
+     * 최상위 창이 표시됐을 때 그 프로세스가 새 추적 대상인지 확인한다 (EVENT_OBJECT_SHOW).
+     * 이미 알거나 확인한 PID는 exe 이름도 다시 읽지 않는다. 추적 앱이면 (인스턴스의 보조 프로세스가 아닌 한) 해석 워커에 넘긴다.
+     */
+    void OnWindowShown(HWND hwnd);
+
+    /**
+     * WindowTitle 인스턴스가 열어 둔 문서 파일로 entity/projectPath/projectName을 갱신한다
+     * (OpenFileResolver, 인스턴스마다 스캔 주기 제한). 찾지 못하면 그대로 둔다.
+     * @param titleName 창 제목에서 읽은 파일 이름 (같은 이름의 열린 파일을 우선한다, 모르면 빈 값)
+     */
+    void RefreshOpenFile(DWORD pid, const std::string& titleName);
 
     /**
-     * PID로 활성 인스턴스 조회. 맵에 없으면 즉석에서 해석을 시도해 등록한다
-     * (포커스 직후 스캔 전이라도 즉시 매핑되도록).
-     * @return 인스턴스 포인터(맵 소유), 추적 대상이 아니면 nullptr
+     * PID로 활성 인스턴스 조회. 보조 프로세스면 루트 인스턴스를 돌려준다 (processId가 pid와 다를 수 있다).
+     * 맵에 없고 추적 앱 프로세스면 해석 워커에 넘기고 nullptr을 돌려준다
+     * (해석이 끝나 CollectResolved로 등록되면 호출자가 포커스를 다시 평가한다).
+     * @return 인스턴스 포인터(맵 소유), 추적 대상이 아니거나 해석 중이면 nullptr
      */
     const AppInstance* ResolveByPid(DWORD pid);
 
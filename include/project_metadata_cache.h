@@ -0,0 +1,57 @@
+#pragma once
+
+#include "globals.h"
+#include <unordered_map>
+
+/**
+ * 프로젝트 메타데이터 (유효성, 에디터 버전, 이름).
+ */
+struct ProjectMetadata {
+    bool valid = false;         // 앱이 요구하는 프로젝트 구조가 있는지 (Unity: Assets + ProjectSettings)
+    std::string editorVersion;  // 없으면 빈 값
+    std::string projectName;
+};
+
+/**
+ * 프로젝트 경로 → 메타데이터 캐시.
+ * 같은 프로젝트를 여는 두 번째 에디터, 해석 실패 PID의 포커스 재해석이 파일 시스템을 다시 뒤지지 않게 한다.
+ *
+ * 키는 경로를 어휘적으로 정규화한 값이다 (구분자 통일, '.'/'..' 정리, 소문자, 끝 구분자 없음 — 파일 시스템 조회 없음).
+ * 유효한 항목은 Invalidate(FileWatcher가 버전 파일 변경을 알릴 때)까지 유지하고,
+ * 무효 항목은 프로젝트가 만들어지는 중일 수 있으므로 kInvalidRetry 뒤에 다시 확인한다.
+ *
+ * 스레드 안전 (조회는 ProcessMonitor 해석 워커 스레드들, 무효화는 FileWatcher 감시 스레드).
+ * load는 락 밖에서 돌므로, 그동안 Invalidate가 오면(키별 세대가 바뀌면) 읽은 값을 캐시에 넣지 않는다.
+ */
+class ProjectMetadataCache {
+public:
+    using Loader = std::function<ProjectMetadata(const std::string& projectPath)>;
+
+    /**
+     * 캐시된 메타데이터. 없거나 만료됐으면 load로 읽어 채운다 (락 밖에서 호출).
+     * load 도중 같은 키가 무효화됐으면 읽은 값을 돌려주기만 하고 캐시하지 않는다 (다음 Get이 다시 읽는다).
+     */
+    ProjectMetadata Get(const std::string& projectPath, const Loader& load);
+
+    /**
+     * 프로젝트 항목을 지운다. 다음 Get에서 다시 읽는다.
+     */
+    void Invalidate(const std::string& projectPath);
+
+private:
+    static constexpr std::chrono::seconds kInvalidRetry{30};
+    static constexpr size_t kMaxEntries = 256;
+
+    struct Entry {
+        ProjectMetadata metadata;
+        std::chrono::steady_clock::time_point loadedAt;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::wstring, Entry> entries; // mutex
+    // 키별 무효화 세대 (mutex). Invalidate마다 증가. 감시한 프로젝트 수만큼만 늘어나므로 비우지 않는다
+    // (비우면 진행 중인 load가 무효화를 놓칠 수 있다).
+    std::unordered_map<std::wstring, uint64_t> generations;
+
+    static std::wstring Key(const std::string& projectPath);
+};
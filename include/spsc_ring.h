@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/**
+ * 단일 생산자/단일 소비자 고정 크기 링 버퍼 (락 없음).
+ * 생산자는 TryPush만, 소비자는 Peek/Pop만 호출한다. 용량은 2의 거듭제곱으로 올림한다.
+ * head/tail은 서로 다른 캐시 라인에 두어 생산자/소비자 간 false sharing을 피한다.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) :
+        mask(RoundUpPowerOfTwo(capacity) - 1),
+        slots(std::make_unique<T[]>(mask + 1))
+    {
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * (생산자) 가득 차 있으면 false를 반환하고 value는 그대로 둔다.
+     */
+    bool TryPush(T& value)
+    {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - cachedHead > mask)
+        {
+            cachedHead = headIndex.load(std::memory_order_acquire);
+            if (tail - cachedHead > mask) return false;
+        }
+
+        slots[tail & mask] = std::move(value);
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * (소비자) 맨 앞 원소. 비어 있으면 nullptr.
+     */
+    T* Peek()
+    {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == cachedTail)
+        {
+            cachedTail = tailIndex.load(std::memory_order_acquire);
+            if (head == cachedTail) return nullptr;
+        }
+        return &slots[head & mask];
+    }
+
+    /**
+     * (소비자) Peek()로 확인한 맨 앞 원소를 버린다.
+     */
+    void Pop()
+    {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        slots[head & mask] = T(); // 문자열 등 보유 메모리 즉시 반환
+        headIndex.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * 대략적인 원소 수 (어느 스레드에서든 호출 가능, 통계용).
+     */
+    size_t SizeApprox() const
+    {
+        const size_t tail = tailIndex.load(std::memory_order_acquire);
+        const size_t head = headIndex.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t Capacity() const { return mask + 1; }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    static size_t RoundUpPowerOfTwo(size_t value)
+    {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+
+    const size_t mask;
+    const std::unique_ptr<T[]> slots;
+
+    alignas(kCacheLine) std::atomic<size_t> headIndex{0}; // 소비자 쓰기
+    size_t cachedTail = 0;                                 // 소비자 전용
+    alignas(kCacheLine) std::atomic<size_t> tailIndex{0}; // 생산자 쓰기
+    size_t cachedHead = 0;                                 // 생산자 전용
+};
@@ -9,6 +9,7 @@
 // 트레이 아이콘 관련 상수들
 #define WM_TRAYICON (WM_USER + 1)    // 트레이 아이콘 메시지
 #define WM_APP_FILE_EVENT (WM_APP + 1) // 파일 변경 큐 적재 통지 (워커 스레드 → 메인 스레드)
+#define WM_APP_PROCESS_EVENT (WM_APP + 2) // 추적 프로세스 종료/해석 완료 통지 (스레드 풀, 해석 워커 → 메인 스레드)
 #define IDM_EXIT 100                 // 종료 메뉴 ID
 #define IDM_SHOW_STATUS 101          // 상태 보기 메뉴 ID
 #define IDM_TOGGLE_MONITORING 102    // 모니터링 토글 메뉴 ID
@@ -17,9 +18,8 @@
 #define IDM_APP_BASE 200             // Tracked Apps 항목 시작 ID (IDM_APP_BASE + index)
 
 // 타이머 ID 및 주기 (메시지 펌프 기반 이벤트화)
-#define TIMER_PROCESS_SCAN 1                 // Unity 프로세스 생성/종료 스캔
+#define TIMER_PROCESS_SCAN 1                 // 프로세스 생성/종료 보조 스캔 (이벤트로 놓친 변화 보정)
 #define TIMER_PERIODIC_HEARTBEAT 2           // 포커스 유지 시 주기 heartbeat
-#define PROCESS_SCAN_INTERVAL_MS 10000       // 10초
 #define PERIODIC_HEARTBEAT_INTERVAL_MS 120000 // 2분
 
 /**
@@ -49,8 +49,10 @@ private:
 
     // 이벤트 허브 콜백 (메시지 펌프에서 디스패치)
     std::function<void()> onFileEvent;       // WM_APP_FILE_EVENT → 파일 이벤트 드레인
+    std::function<void()> onProcessEvent;    // WM_APP_PROCESS_EVENT → 종료/해석 완료 인스턴스 처리
     std::function<void()> onProcessScan;     // TIMER_PROCESS_SCAN → 프로세스 생성/종료 스캔
     std::function<void()> onPeriodicTick;    // TIMER_PERIODIC_HEARTBEAT → 주기 heartbeat 체크
+    std::function<void()> onInteraction;     // 트레이 아이콘 클릭 → 프로세스 스캔 주기 당김
     
     /**
      * 숨겨진 창 생성 (트레이 아이콘 메시지 수신용)
@@ -156,9 +158,11 @@ public:
     void SetCurrentProject(const std::string& projectName);
     
     /**
-     * heartbeat 카운터 증가
+     * heartbeat 카운터를 count만큼 올리고 활동 컨텍스트를 설정 (툴팁 갱신 1회)
+     * @param count 추가된 heartbeat 수 (0이면 컨텍스트만 갱신)
+     * @param contextName 프로젝트 또는 도구 이름
      */
-    void IncrementHeartbeats();
+    void AddHeartbeats(size_t count, const std::string& contextName);
     
     /**
      * 모니터링 상태 설정
@@ -196,16 +200,21 @@ public:
      */
     void NotifyFileEvent();
 
+    /**
+     * 추적 프로세스 종료/해석 완료를 메인 스레드에 통지 (어느 스레드에서나 호출 가능, WM_APP_PROCESS_EVENT를 post).
+     */
+    void NotifyProcessEvent();
+
     /**
      * 상태 정보 업데이트 (서브메뉴에 반영)
      */
     void RefreshStatusMenu();
 
     /**
-     * 프로세스 스캔 타이머 동적 제어 (활성 앱 수 0이면 끈다).
-     * @param active true면 TIMER_PROCESS_SCAN 설치, false면 해제
+     * 프로세스 스캔 타이머 동적 제어 (활성 앱 수 0이면 끈다, 주기는 ProcessMonitor가 정한다).
+     * @param intervalMs TIMER_PROCESS_SCAN 주기, 0이면 해제
      */
-    void SetProcessScanActive(bool active);
+    void SetProcessScanInterval(UINT intervalMs);
 
     /**
      * 모니터링 상태 반환
@@ -255,6 +264,11 @@ public:
      */
     void SetFileEventCallback(const std::function<void()> &callback);
 
+    /**
+     * 프로세스 종료/해석 완료 통지 처리 콜백 설정 (WM_APP_PROCESS_EVENT)
+     */
+    void SetProcessEventCallback(const std::function<void()> &callback);
+
     /**
      * 프로세스 스캔 콜백 설정 (TIMER_PROCESS_SCAN)
      */
@@ -265,6 +279,11 @@ public:
      */
     void SetPeriodicTickCallback(const std::function<void()> &callback);
 
+    /**
+     * 트레이 아이콘 클릭(메뉴 열기/더블클릭) 콜백 설정
+     */
+    void SetInteractionCallback(const std::function<void()> &callback);
+
 private:
     /**
      * 정적 윈도우 프로시저 - Windows API 콜백용
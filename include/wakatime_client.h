@@ -20,9 +20,13 @@ struct HeartbeatData {
     std::string project;            // 프로젝트 이름
     std::string language;           // WakaTime language
     std::string editor;             // "Unity 2022.3" 등
+    std::string branch;             // Git 브랜치 (모르면 빈 값, JSON에서 생략)
     std::string operating_system;   // "Windows"
     int64_t time;                   // Unix timestamp
     bool is_write;                  // 파일 수정 여부
+    int64_t lines;                  // 파일 줄 수, 모르면 -1 (JSON에서 생략)
+    int64_t line_additions;         // 직전 내용 대비 늘어난 줄 수 (순증감 기준)
+    int64_t line_deletions;         // 직전 내용 대비 줄어든 줄 수 (순증감 기준)
     int retryCount;                 // 전송 실패 재시도 횟수
 
     HeartbeatData() :
@@ -31,6 +35,9 @@ struct HeartbeatData {
         operating_system("Windows"),
         time(0),
         is_write(false),
+        lines(-1),
+        line_additions(0),
+        line_deletions(0),
         retryCount(0) {}
 };
 
@@ -107,6 +114,13 @@ private:
      */
     std::string GetMachineName();
 
+    /**
+     * 앱 정의(language/editor)를 채운 HeartbeatData 생성
+     * @param time Unix timestamp (0이면 현재 시각)
+     */
+    HeartbeatData BuildHeartbeat(const std::string& appId, const std::string& entity, const std::string& project,
+                                 const std::string& editorVersion, bool isWrite, int64_t time);
+
     /**
      * Unix timestamp 생성 (현재 시간)
      * @return Unix timestamp (초 단위)
@@ -189,15 +203,19 @@ public:
      * @param project 프로젝트 이름
      * @param editorVersion 에디터 버전 (없으면 빈 값)
      * @param isWrite 파일 수정 여부
+     * @param time heartbeat 시각 (Unix timestamp, 0이면 현재 시각)
      */
     bool SendHeartbeat(const std::string& appId, const std::string& entity, const std::string& project,
-                       const std::string& editorVersion, bool isWrite = true);
+                       const std::string& editorVersion, bool isWrite = true, int64_t time = 0);
     
     /**
-     * FileChangeEvent에서 자동으로 Heartbeat 생성해서 전송
-     * @param event 파일 변경 이벤트
+     * FileChangeEvent 배열에서 Heartbeat를 만들어 한 번에 큐에 적재 (큐 락 1회).
+     * heartbeat 시각은 event.timestamp를 쓴다 (오프라인 catch-up 이벤트는 파일 수정 시각으로 소급).
+     * @param events 파일 변경 이벤트 배열
+     * @param count 이벤트 수
+     * @return 실제로 큐에 들어간 heartbeat 수 (debounce/Pause로 걸러진 것 제외)
      */
-    bool SendHeartbeatFromEvent(const FileChangeEvent& event);
+    size_t SendHeartbeatsFromEvents(const FileChangeEvent* events, size_t count);
 
     /**
      * 외부에서 완성된 HeartbeatData를 전송 큐에 적재 (비동기).
@@ -206,6 +224,14 @@ public:
      * @param heartbeat 적재할 heartbeat 데이터
      */
     bool EnqueueHeartbeat(const HeartbeatData& heartbeat);
+
+    /**
+     * EnqueueHeartbeat의 배치 버전. 큐 락과 전송 스레드 깨우기를 배치당 1회만 한다.
+     * @param heartbeats heartbeat 배열
+     * @param count heartbeat 수
+     * @return 실제로 큐에 들어간 heartbeat 수
+     */
+    size_t EnqueueHeartbeats(const HeartbeatData* heartbeats, size_t count);
     
     /**
      * 전송 큐에 대기 중인 heartbeat 수
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "globals.h"
+#include "notify_buffer_pool.h"
+
+/**
+ * 디렉토리 변경 알림 수신함. 구독자(프로젝트 감시 스레드)마다 하나.
+ * 레지스트리 I/O 스레드가 채우고 event를 신호하면, 감시 스레드가 items를 통째로 가져간다.
+ */
+struct WatchInbox {
+    struct Notification {
+        size_t rootTag;   // Subscribe에 넘긴 태그 (구독자가 자기 root를 찾는 용도), 수신함 적체면 kOverflowTag
+        std::string path; // 구독한 디렉토리 기준 상대 경로 (UTF-8, '/' 구분자)
+        DWORD action;     // FILE_ACTION_*. 0이면 알림이 유실됨(overflow) → 재스캔 필요
+    };
+
+    // 수신함 적체 표시 태그. 쌓여 있던 모든 구독의 알림을 버렸으므로 어느 구독에서 넘쳤든 구독자 전체를 다시 봐야 한다.
+    // Subscribe의 rootTag로 쓰지 않는다.
+    static constexpr size_t kOverflowTag = SIZE_MAX;
+
+    std::mutex mutex;
+    std::vector<Notification> items; // mutex
+    HANDLE event;                    // items 도착 (auto-reset)
+
+    WatchInbox() : event(CreateEvent(nullptr, FALSE, FALSE, nullptr)) {}
+
+    ~WatchInbox() {
+        if (event != nullptr) {
+            CloseHandle(event);
+            event = nullptr;
+        }
+    }
+
+    WatchInbox(const WatchInbox&) = delete;
+    WatchInbox& operator=(const WatchInbox&) = delete;
+};
+
+/**
+ * ReadDirectoryChangesW 구독 레지스트리 (FileWatcher 하나가 소유, 모든 프로젝트가 공유).
+ *
+ * 정규화 경로(GetFinalPathNameByHandleW, 소문자) 기준으로, 이미 감시 중인 디렉토리와 같거나 그 하위를 구독하면
+ * 커널 감시를 새로 만들지 않고 구독자만 붙인다 (구독자 수가 곧 ref-count). 더 넓은 디렉토리가 들어오면
+ * 그 아래 기존 감시의 구독자를 옮겨 붙이고 기존 감시는 닫는다. 마지막 구독자가 빠지면 감시를 닫는다.
+ * 비재귀 감시는 같은 디렉토리의 비재귀 구독끼리만 공유한다 (재귀 감시에는 비재귀 구독도 붙을 수 있다).
+ *
+ * 모든 감시는 IOCP 스레드 하나가 처리하며, 알림 1건을 관심 있는 모든 구독자 수신함으로 나눠 준다.
+ * 구독/해제는 어느 스레드에서나 호출할 수 있다.
+ *
+ * 알림 버퍼는 풀에서 최소 크기로 빌려 시작하고, 오버플로가 나면 키우고 오래 조용하면 줄인다.
+ * 커널은 핸들에 처음 건 요청의 크기로 내부 버퍼를 잡으므로, 크기 변경은 새 핸들을 열어 감시를 통째로 교체한다.
+ */
+class WatchRegistry {
+public:
+    using SubscriptionId = uint64_t;
+
+    WatchRegistry();
+    ~WatchRegistry();
+
+    WatchRegistry(const WatchRegistry&) = delete;
+    WatchRegistry& operator=(const WatchRegistry&) = delete;
+
+    /**
+     * 디렉토리의 변경 알림을 inbox로 받도록 구독한다.
+     * @param directory 감시할 디렉토리 (UTF-16)
+     * @param inbox 알림을 받을 수신함
+     * @param rootTag 알림에 그대로 실어 보낼 태그 (WatchInbox::kOverflowTag 제외)
+     * @param recursive false면 디렉토리 바로 아래 항목만 받는다 (하위 폴더 변경으로 깨어나지 않는다)
+     * @return 구독 id, 실패하면 0
+     */
+    SubscriptionId Subscribe(const std::wstring& directory, std::shared_ptr<WatchInbox> inbox, size_t rootTag,
+                             bool recursive = true);
+
+    struct WatchStats {
+        size_t bufferSize = 0;  // 현재 알림 버퍼 크기
+        uint64_t overflows = 0; // 알림 유실(오버플로) 횟수
+        uint64_t resizes = 0;   // 버퍼 크기 변경 횟수
+    };
+
+    /**
+     * 구독이 붙어 있는 커널 감시의 통계. 공유 감시면 함께 쓰는 구독자에게 같은 값이 보인다.
+     */
+    WatchStats GetStats(SubscriptionId id) const;
+
+    /**
+     * 구독 해제. 반환 후에는 이 구독으로 새 알림이 들어가지 않는다.
+     */
+    void Unsubscribe(SubscriptionId id);
+
+    /**
+     * 중복 판정에 쓰는 정규화 경로 (심볼릭 링크/정션 해석, 소문자, 끝 구분자 없음). 열 수 없으면 빈 값.
+     */
+    static std::wstring CanonicalPath(const std::wstring& directory);
+
+    /**
+     * 둘 다 CanonicalPath 결과일 때, path가 ancestor와 같거나 그 하위이면 true.
+     * @param remainder 하위이면 ancestor 기준 나머지 경로 (같으면 빈 값)
+     */
+    static bool IsWithin(const std::wstring& path, const std::wstring& ancestor, std::wstring* remainder = nullptr);
+
+    /**
+     * 현재 열려 있는 커널 감시 수 (통계용).
+     */
+    size_t KernelWatchCount() const;
+
+private:
+    // 한 구독자가 보류 중인 알림이 이보다 많으면 비우고 overflow 1건으로 대신한다 (재스캔으로 복구).
+    static constexpr size_t kMaxInboxItems = 16384;
+    // 오버플로마다 버퍼를 이 배수로 키운다.
+    static constexpr size_t kGrowFactor = 4;
+    // 마지막 크기 변경 이후 이만큼 오버플로 없이 사용량이 버퍼의 1/4 미만이면 줄인다.
+    static constexpr std::chrono::minutes kShrinkAfterQuiet{5};
+    // 축소 판정 주기 (알림이 없어도 I/O 스레드가 깨어난다)
+    static constexpr DWORD kRebalanceIntervalMs = 60 * 1000;
+    // 네트워크 공유 폴더는 64KB를 넘는 버퍼를 받지 않는다 (ERROR_INVALID_PARAMETER).
+    static constexpr size_t kNetworkBufferLimit = 64 * 1024;
+
+    struct Subscriber {
+        SubscriptionId id;
+        std::shared_ptr<WatchInbox> inbox;
+        size_t rootTag;
+        std::wstring filter; // 감시 디렉토리 기준 하위 경로 + '\' (감시 디렉토리 자체를 구독했으면 빈 값)
+        bool recursive;      // false면 filter 바로 아래 항목만 전달
+    };
+
+    struct Watch {
+        std::wstring key;               // 정규화 경로
+        HANDLE directoryHandle = INVALID_HANDLE_VALUE;
+        OVERLAPPED overlapped{};
+        bool pending = false;           // ReadDirectoryChangesW가 걸려 있음
+        bool recursive = true;          // bWatchSubtree
+        std::vector<Subscriber> subscribers;
+        NotifyBufferPool::Buffer buffer;
+        size_t maxBufferSize = 0;       // 이 감시가 키울 수 있는 최대 크기
+        size_t peakBytes = 0;           // 마지막 크기 변경 이후 한 번에 받은 최대 바이트
+        std::chrono::steady_clock::time_point lastResize;
+        uint64_t overflows = 0;
+        uint64_t resizes = 0;
+    };
+
+    NotifyBufferPool bufferPool; // 감시보다 먼저 선언 (버퍼가 풀로 돌아간 뒤 풀이 소멸해야 한다)
+    HANDLE completionPort;
+    std::thread ioThread;
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Watch>> watches; // 활성 감시 (mutex)
+    std::vector<std::unique_ptr<Watch>> retired; // 취소 완료를 기다리는 감시, I/O 스레드가 해제 (mutex)
+    SubscriptionId nextId = 1;                   // mutex
+    bool stopping = false;                       // mutex
+
+    void IoThread();
+
+    /**
+     * 디렉토리 핸들로 감시를 만들고 IOCP에 묶어 첫 요청을 건다 (mutex 보유). 실패하면 핸들을 닫고 nullptr.
+     * @param buffer 풀에서 빌린 알림 버퍼 (감시가 가져간다)
+     * @param recursive 하위 디렉토리까지 감시하면 true
+     * @param armError 첫 요청이 실패했을 때의 오류 코드
+     */
+    std::unique_ptr<Watch> OpenWatch(HANDLE handle, const std::wstring& key, NotifyBufferPool::Buffer buffer,
+                                     bool recursive, DWORD* armError = nullptr);
+
+    /**
+     * ReadDirectoryChangesW를 다시 건다 (mutex 보유). 오버플로면 구독자에게 알리고 한 번 더 시도한다.
+     * @param error 실패 시 오류 코드
+     */
+    bool Arm(Watch& watch, DWORD* error = nullptr);
+
+    /**
+     * 같은 디렉토리를 새 핸들·새 버퍼 크기로 다시 열어 감시를 교체한다 (mutex 보유).
+     * 새 감시가 걸린 뒤 기존 감시를 닫으므로 그 사이 알림은 중복될 수는 있어도 빠지지 않는다.
+     * 풀 상한 때문에 원하는 방향으로 크기가 바뀌지 않으면 다시 열지 않는다.
+     * @return 교체했으면 true (it는 무효가 된다)
+     */
+    bool Resize(std::vector<std::unique_ptr<Watch>>::iterator it, size_t bufferSize);
+
+    /**
+     * 오래 조용했던 감시의 버퍼를 줄인다 (mutex 보유).
+     */
+    void ShrinkQuietWatches();
+
+    /**
+     * 감시를 watches에서 빼고 취소한다 (mutex 보유). 걸린 I/O가 없으면 바로 닫는다.
+     */
+    void Retire(std::vector<std::unique_ptr<Watch>>::iterator it);
+
+    /**
+     * 완료된 버퍼를 해석해 구독자별로 걸러 수신함에 넣는다 (mutex 보유). bytes가 0이면 overflow로 알린다.
+     */
+    static void Dispatch(const Watch& watch, DWORD bytes);
+
+    static void Deliver(const Subscriber& subscriber, std::vector<WatchInbox::Notification>& items);
+};
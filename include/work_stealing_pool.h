@@ -0,0 +1,52 @@
+#pragma once
+
+#include "globals.h"
+#include <deque>
+
+/**
+ * 디렉토리 스캔용 소형 work-stealing 풀.
+ * 워커마다 자기 deque를 두고 자기 작업은 뒤에서, 남의 작업은 앞에서 훔쳐 간다.
+ * 스레드는 Run() 동안만 존재한다 (스캔은 드물게 일어나므로 상주 스레드를 두지 않는다).
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param workerCount 워커 수 (0이면 코어 수, 최대 kMaxWorkers). 호출 스레드도 워커 하나로 참여한다.
+     */
+    explicit WorkStealingPool(size_t workerCount = 0);
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * seed 작업을 워커에 나눠 주고, 실행 중 Spawn된 작업까지 모두 끝나거나 취소될 때까지 블록한다.
+     * 취소 시 아직 시작하지 않은 작업은 버린다.
+     * @return 모든 작업을 끝냈으면 true, 취소되었으면 false
+     */
+    bool Run(std::vector<Task> seeds, const std::atomic<bool>& cancel);
+
+    /**
+     * 실행 중인 작업 안에서 하위 작업을 추가한다 (현재 워커 deque 뒤에 넣는다).
+     */
+    void Spawn(Task task);
+
+    size_t WorkerCount() const { return workers.size(); }
+
+private:
+    static constexpr size_t kMaxWorkers = 8;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t> outstanding{0}; // 큐에 있거나 실행 중인 작업 수
+    const std::atomic<bool>* cancelFlag = nullptr;
+
+    void WorkerLoop(size_t index);
+    bool TryPop(size_t index, Task& task);
+    bool TrySteal(size_t index, Task& task);
+};
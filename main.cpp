@@ -39,28 +39,38 @@ namespace
         return label;
     }
 
-    // 활성 앱이 하나라도 있으면 프로세스 스캔 타이머를 켜고, 0이면 끈다.
+    // 활성 앱이 하나라도 있으면 프로세스 스캔 타이머를 ProcessMonitor가 정한 주기로 켜고, 0이면 끈다.
     void UpdateProcessScanTimer()
     {
-        if (g_trayIcon) g_trayIcon->SetProcessScanActive(AppRegistry::EnabledCount() > 0);
+        if (g_trayIcon == nullptr || g_processMonitor == nullptr) return;
+        g_trayIcon->SetProcessScanInterval(AppRegistry::EnabledCount() > 0 ? g_processMonitor->GetScanIntervalMs() : 0);
     }
 }
 
-// 파일 변경 이벤트 처리 (DirectoryWatch 앱)
-void OnFileChanged(const FileChangeEvent &event)
+// 파일 변경 이벤트 배치 처리 (DirectoryWatch 앱). 배치당 큐 락 1회, 툴팁 갱신 1회.
+void OnFileEvents(const FileChangeEvent *events, const size_t count)
 {
-    WT_LOG("[HEARTBEAT] " << event.fileName << " (" << event.projectName << ")");
+    if (count == 0) return;
 
-    bool queued = false;
+    const FileChangeEvent &last = events[count - 1];
+    if (count == 1)
+    {
+        WT_LOG("[HEARTBEAT] " << last.relativePath << " (" << last.context->projectName << ")");
+    }
+    else
+    {
+        WT_LOG("[HEARTBEAT] " << count << " file events, last: " << last.relativePath << " (" << last.context->projectName << ")");
+    }
+
+    size_t queued = 0;
     if (g_wakatimeClient && g_wakatimeClient->IsInitialized())
     {
-        queued = g_wakatimeClient->SendHeartbeatFromEvent(event);
+        queued = g_wakatimeClient->SendHeartbeatsFromEvents(events, count);
     }
 
     if (g_trayIcon)
     {
-        if (queued) g_trayIcon->IncrementHeartbeats();
-        g_trayIcon->SetActiveContext(ContextLabel(event.appId, event.projectName));
+        g_trayIcon->AddHeartbeats(queued, ContextLabel(last.context->appId, last.context->projectName));
     }
 }
 
@@ -74,8 +84,7 @@ void OnFocusHeartbeat(const std::string &appId, const std::string &entity,
 
     if (g_trayIcon)
     {
-        if (queued) g_trayIcon->IncrementHeartbeats();
-        g_trayIcon->SetActiveContext(ContextLabel(appId, project));
+        g_trayIcon->AddHeartbeats(queued ? 1 : 0, ContextLabel(appId, project));
     }
 }
 
@@ -159,9 +168,35 @@ void InitialScan()
     if (!g_processMonitor) return;
 
     WT_LOG("[Main] Performing initial process scan...");
-    const auto &instances = g_processMonitor->ScanProcesses();
-    HandleNewInstances(instances);
-    WT_LOG("[Main] Initial scan complete. Found " << instances.size() << " instances");
+    // 해석은 워커에서 돈다. 끝난 인스턴스는 프로세스 이벤트(OnProcessEvents)로 들어온다.
+    const size_t submitted = g_processMonitor->ScanProcesses();
+    WT_LOG("[Main] Initial scan complete. Resolving " << submitted << " instances");
+}
+
+// 프로세스 이벤트 (종료 대기 통지, 해석 완료) — 메인 스레드
+void OnProcessEvents()
+{
+    if (!g_processMonitor) return;
+
+    std::vector<AppInstance> closed;
+    std::vector<AppInstance> started;
+    g_processMonitor->CollectExited(closed);
+    g_processMonitor->CollectResolved(started);
+    // 종료를 먼저 처리한다 (같은 프로젝트를 다시 연 경우 감시를 멈췄다가 곧바로 다시 시작하도록).
+    if (!closed.empty()) HandleClosedInstances(closed);
+    if (started.empty()) return;
+
+    HandleNewInstances(started);
+
+    // 해석 중이라 미뤄둔 포커스: 포그라운드가 방금 등록된 프로세스면 다시 평가한다.
+    const HWND foreground = GetForegroundWindow();
+    DWORD foregroundPid = 0;
+    if (foreground != nullptr) GetWindowThreadProcessId(foreground, &foregroundPid);
+    const bool focused = std::any_of(started.begin(), started.end(), [foregroundPid](const AppInstance &instance)
+    {
+        return instance.processId == foregroundPid;
+    });
+    if (focused && g_focusDetector) g_focusDetector->OnForegroundChanged(foreground);
 }
 
 // 트레이 콜백 함수들
@@ -232,11 +267,12 @@ void OnToggleApp(const std::string &appId, const bool enabled)
 
         if (g_processMonitor)
         {
-            std::vector<AppInstance> started;
+            // 새 인스턴스는 해석이 끝나면 OnProcessEvents로 들어온다.
             std::vector<AppInstance> closed;
-            g_processMonitor->PollChanges(started, closed);
-            if (!started.empty()) HandleNewInstances(started);
+            g_processMonitor->PollChanges(closed);
             if (!closed.empty()) HandleClosedInstances(closed);
+            // 방금 켠 앱을 곧 실행할 가능성이 높으므로 다음 스캔을 당겨둔다.
+            g_processMonitor->TightenScan();
         }
 
         if (g_trayIcon) g_trayIcon->ShowInfoNotification(name + " tracking enabled");
@@ -252,6 +288,16 @@ void OnToggleApp(const std::string &appId, const bool enabled)
     }
 }
 
+// 최상위 창 표시 콜백: 추적 앱의 새 프로세스를 스캔 주기를 기다리지 않고 감지한다.
+void CALLBACK LifecycleWinEventProc(HWINEVENTHOOK, DWORD, const HWND hwnd,
+                                    const LONG idObject, const LONG idChild, DWORD, DWORD)
+{
+    if (idObject != OBJID_WINDOW || idChild != CHILDID_SELF || hwnd == nullptr || g_processMonitor == nullptr) return;
+    if (GetAncestor(hwnd, GA_ROOT) != hwnd) return; // 자식 창/컨트롤 표시는 무시
+
+    g_processMonitor->OnWindowShown(hwnd);
+}
+
 // 포커스/제목 변경 이벤트 콜백 (SetWinEventHook, OUTOFCONTEXT → 메인 펌프에서 디스패치).
 void CALLBACK FocusWinEventProc(HWINEVENTHOOK, const DWORD event, const HWND hwnd,
                                 const LONG idObject, LONG, DWORD, DWORD)
@@ -309,7 +355,23 @@ int main()
     g_processMonitor = &processMonitor;
     g_fileWatcher = &fileWatcher;
 
-    fileWatcher.SetChangeCallback(OnFileChanged);
+    // 추적 프로세스 종료(스레드 풀 대기 콜백)/해석 완료(해석 워커) → 메인 스레드로 PostMessage 마샬링. 초기 스캔 전에 연결한다.
+    processMonitor.SetLifecycleCallback([&trayIcon]()
+    {
+        trayIcon.NotifyProcessEvent();
+    });
+    // 스캔 결과/포그라운드 변화로 주기가 바뀌면 타이머를 다시 건다.
+    processMonitor.SetScanIntervalCallback([](uint32_t)
+    {
+        UpdateProcessScanTimer();
+    });
+
+    fileWatcher.SetChangeCallback(OnFileEvents);
+    // ProjectVersion.txt 변경(에디터 업그레이드) → 다음 해석이 버전을 다시 읽도록 캐시 무효화
+    fileWatcher.SetMetadataCallback([&processMonitor](const std::string &projectPath)
+    {
+        processMonitor.InvalidateProjectMetadata(projectPath);
+    });
     // 워커 스레드의 파일 변경 → 메인 스레드로 PostMessage 마샬링
     fileWatcher.SetNotifyCallback([&trayIcon]()
     {
@@ -335,12 +397,12 @@ int main()
         if (g_fileWatcher) g_fileWatcher->DrainPendingEvents();
     });
 
+    trayIcon.SetProcessEventCallback(OnProcessEvents);
+
     trayIcon.SetProcessScanCallback([&processMonitor]()
     {
-        std::vector<AppInstance> started;
         std::vector<AppInstance> closed;
-        processMonitor.PollChanges(started, closed);
-        if (!started.empty()) HandleNewInstances(started);
+        processMonitor.PollChanges(closed);
         if (!closed.empty()) HandleClosedInstances(closed);
     });
 
@@ -349,6 +411,12 @@ int main()
         if (g_focusDetector) g_focusDetector->SendPeriodicHeartbeat();
     });
 
+    // 트레이를 연다 = 방금 띄운 도구가 잡혔는지 확인하려는 경우가 많다 → 다음 스캔을 당긴다.
+    trayIcon.SetInteractionCallback([&processMonitor]()
+    {
+        processMonitor.TightenScan();
+    });
+
     // 포커스 추적 훅 2개: 포그라운드 전이 + 제목 변경.
     const HWINEVENTHOOK foregroundHook = SetWinEventHook(
         EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
@@ -360,6 +428,12 @@ int main()
         nullptr, FocusWinEventProc, 0, 0,
         WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
 
+    // 프로세스 시작 감지 훅: 최상위 창 표시.
+    const HWINEVENTHOOK showHook = SetWinEventHook(
+        EVENT_OBJECT_SHOW, EVENT_OBJECT_SHOW,
+        nullptr, LifecycleWinEventProc, 0, 0,
+        WINEVENT_OUTOFCONTEXT | WINEVENT_SKIPOWNPROCESS);
+
     // 훅 설치 시점에 이미 추적 대상이 포그라운드일 수 있으므로 초기 상태 1회 캡처
     focusDetector.OnForegroundChanged(GetForegroundWindow());
 
@@ -368,6 +442,7 @@ int main()
 
     if (foregroundHook) UnhookWinEvent(foregroundHook);
     if (nameChangeHook) UnhookWinEvent(nameChangeHook);
+    if (showHook) UnhookWinEvent(showHook);
 
     WT_LOG("\n[Main] Shutting down Creative WakaTime...");
     trayIcon.ShowInfoNotification("Creative WakaTime shutting down...");
@@ -377,7 +452,7 @@ int main()
     {
         if (g_fileWatcher)
         {
-            g_fileWatcher->DrainPendingEvents(2048);
+            g_fileWatcher->DrainPendingEvents(std::chrono::milliseconds(500));
         }
 
         WT_LOG("[Main] Flushing remaining heartbeats...");
@@ -19,6 +19,27 @@ namespace
                        [](const wchar_t c) { return static_cast<wchar_t>(::towlower(c)); });
         return s;
     }
+
+    // lowercase exe → AppDefinition* 맵과 이름 길이 표
+    struct ProcessIndex {
+        std::unordered_map<std::wstring, const AppDefinition*> byName;
+        std::vector<bool> nameLengths; // 길이 → 그 길이의 등록 이름이 있는지
+
+        void Add(const std::wstring& name, const AppDefinition* def)
+        {
+            if (nameLengths.size() <= name.size()) nameLengths.resize(name.size() + 1, false);
+            nameLengths[name.size()] = true;
+            byName[ToLowerW(name)] = def;
+        }
+
+        const AppDefinition* Find(const std::wstring_view exe) const
+        {
+            if (exe.size() >= nameLengths.size() || !nameLengths[exe.size()]) return nullptr;
+
+            const auto it = byName.find(ToLowerW(std::wstring(exe)));
+            return it != byName.end() ? it->second : nullptr;
+        }
+    };
 }
 
 const std::vector<AppDefinition>& AppRegistry::All()
@@ -31,10 +52,22 @@ const std::vector<AppDefinition>& AppRegistry::All()
         unity.id = "unity";
         unity.displayName = "Unity";
         unity.processNames = {L"Unity.exe", L"Unity"};
+        // AssetImportWorker는 Unity.exe로 뜨므로 processNames로 묶인다.
+        unity.helperProcessNames = {L"Unity.Licensing.Client.exe"};
         unity.fileExtensions = {
             ".unity", ".prefab", ".asset", ".mat", ".shader",
             ".hlsl", ".anim", ".controller", ".json",
         };
+        // 텍스트(YAML/소스) 에셋. 바이너리 직렬화로 저장된 파일은 세지 않는다.
+        unity.lineCountExtensions = {
+            ".unity", ".prefab", ".asset", ".mat", ".shader",
+            ".hlsl", ".anim", ".controller", ".json",
+        };
+        // Library/Temp/Logs 등 임포트·컴파일 중 쓰기가 몰리는 폴더는 커널 구독 자체에서 뺀다.
+        unity.watchRoots = {"Assets", "Packages", "ProjectSettings"};
+        // 프로젝트 밖에 있는 file: 패키지도 감시한다.
+        unity.packageManifest = "Packages/manifest.json";
+        unity.metadataFile = "ProjectSettings/ProjectVersion.txt";
         unity.language = "Unity";
         unity.editor = "Unity";
         unity.strategy = TrackStrategy::DirectoryWatch;
@@ -87,24 +120,34 @@ const std::vector<AppDefinition>& AppRegistry::All()
     return definitions;
 }
 
-const AppDefinition* AppRegistry::FindByProcessName(const std::wstring& exe)
+const AppDefinition* AppRegistry::FindByProcessName(const std::wstring_view exe)
 {
-    // lowercase exe → AppDefinition* 맵을 1회 빌드해 재사용.
-    static const std::unordered_map<std::wstring, const AppDefinition*> byProcess = []
+    // 등록 이름 색인을 1회 빌드해 재사용.
+    static const ProcessIndex index = []
     {
-        std::unordered_map<std::wstring, const AppDefinition*> map;
+        ProcessIndex built;
         for (const auto& def : All())
         {
-            for (const auto& name : def.processNames)
-            {
-                map[ToLowerW(name)] = &def;
-            }
+            for (const auto& name : def.processNames) built.Add(name, &def);
         }
-        return map;
+        return built;
     }();
+    return index.Find(exe);
+}
 
-    const auto it = byProcess.find(ToLowerW(exe));
-    return it != byProcess.end() ? it->second : nullptr;
+const AppDefinition* AppRegistry::FindByHelperName(const std::wstring_view exe)
+{
+    static const ProcessIndex index = []
+    {
+        ProcessIndex built;
+        for (const auto& def : All())
+        {
+            for (const auto& name : def.processNames) built.Add(name, &def);
+            for (const auto& name : def.helperProcessNames) built.Add(name, &def);
+        }
+        return built;
+    }();
+    return index.Find(exe);
 }
 
 const AppDefinition* AppRegistry::FindById(const std::string& id)
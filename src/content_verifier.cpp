@@ -0,0 +1,277 @@
+#include "content_verifier.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define WT_COUNT_LINES_SSE2 1
+#endif
+
+namespace
+{
+    // 이보다 큰 파일은 해시하지 않고 변경으로 본다 (대형 바이너리 에셋을 통째로 읽지 않기 위함).
+    constexpr uint64_t kMaxHashBytes = 256ull * 1024 * 1024;
+    // 앞부분에 NUL이 있으면 바이너리로 보고 줄 수를 세지 않는다 (바이너리 직렬화 에셋 등, git과 같은 휴리스틱).
+    constexpr size_t kBinaryProbeBytes = 8000;
+
+    constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+    uint64_t RotateLeft(const uint64_t value, const int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    uint64_t Read64(const unsigned char *p)
+    {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t Read32(const unsigned char *p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint64_t Round(uint64_t acc, const uint64_t input)
+    {
+        acc += input * kPrime2;
+        acc = RotateLeft(acc, 31);
+        return acc * kPrime1;
+    }
+
+    uint64_t MergeRound(uint64_t acc, const uint64_t value)
+    {
+        acc ^= Round(0, value);
+        return acc * kPrime1 + kPrime4;
+    }
+
+    uint64_t ToUInt64(const DWORD high, const DWORD low)
+    {
+        return (static_cast<uint64_t>(high) << 32) | low;
+    }
+}
+
+ContentVerifier::ContentVerifier(const size_t capacity) :
+    capacity(std::max<size_t>(1, capacity))
+{
+}
+
+uint64_t ContentVerifier::Hash(const void *data, const size_t length)
+{
+    // XXH64 (little-endian 전제, x86/x64 Windows 전용이므로 바이트 순서 변환 생략)
+    const auto *p = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = p + length;
+    uint64_t h;
+
+    if (length >= 32)
+    {
+        const unsigned char *const limit = end - 32;
+        uint64_t v1 = kPrime1 + kPrime2;
+        uint64_t v2 = kPrime2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - kPrime1;
+
+        do
+        {
+            v1 = Round(v1, Read64(p));
+            v2 = Round(v2, Read64(p + 8));
+            v3 = Round(v3, Read64(p + 16));
+            v4 = Round(v4, Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        h = MergeRound(h, v1);
+        h = MergeRound(h, v2);
+        h = MergeRound(h, v3);
+        h = MergeRound(h, v4);
+    }
+    else
+    {
+        h = kPrime5;
+    }
+
+    h += static_cast<uint64_t>(length);
+
+    while (p + 8 <= end)
+    {
+        h ^= Round(0, Read64(p));
+        h = RotateLeft(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end)
+    {
+        h ^= static_cast<uint64_t>(Read32(p)) * kPrime1;
+        h = RotateLeft(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end)
+    {
+        h ^= (*p) * kPrime5;
+        h = RotateLeft(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+int64_t ContentVerifier::CountLines(const void *data, const size_t length)
+{
+    if (length == 0) return 0;
+
+    const auto *p = static_cast<const unsigned char *>(data);
+    const unsigned char *const end = p + length;
+    uint64_t newlines = 0;
+
+#ifdef WT_COUNT_LINES_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    while (end - p >= 16)
+    {
+        // 바이트별 카운터(0xFF 비교 결과를 빼서 +1)는 255번까지 넘치지 않는다. 그때마다 SAD로 합쳐 비운다.
+        const size_t blocks = std::min<size_t>(static_cast<size_t>(end - p) / 16, 255);
+        __m128i counts = zero;
+        for (size_t i = 0; i < blocks; ++i, p += 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chunk, newline));
+        }
+        const __m128i sums = _mm_sad_epu8(counts, zero);
+        newlines += static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_extract_epi16(sums, 4));
+    }
+#endif
+
+    while (p < end)
+    {
+        newlines += (*p == '\n') ? 1 : 0;
+        ++p;
+    }
+
+    return static_cast<int64_t>(newlines) + (end[-1] != '\n' ? 1 : 0);
+}
+
+bool ContentVerifier::HasContentChanged(const std::string &key, const std::wstring &fullPath, LineStats *lineStats)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data{};
+    if (!GetFileAttributesExW(fullPath.c_str(), GetFileExInfoStandard, &data) ||
+        (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+    {
+        Forget(key);
+        return true;
+    }
+
+    const uint64_t size = ToUInt64(data.nFileSizeHigh, data.nFileSizeLow);
+    const uint64_t writeTime = ToUInt64(data.ftLastWriteTime.dwHighDateTime, data.ftLastWriteTime.dwLowDateTime);
+
+    const auto it = entries.find(key);
+    if (it != entries.end())
+    {
+        lru.splice(lru.begin(), lru, it->second.lruPosition);
+
+        // 크기/시각이 그대로면 다시 쓰인 적이 없다 (속성 변경 등). 읽지 않는다.
+        if (it->second.size == size && it->second.writeTime == writeTime)
+        {
+            if (lineStats != nullptr) lineStats->lines = it->second.lines;
+            return false;
+        }
+    }
+
+    uint64_t hash = 0;
+    int64_t lines = -1;
+    if (size > kMaxHashBytes || !HashFile(fullPath, size, hash, lineStats != nullptr ? &lines : nullptr))
+    {
+        Forget(key);
+        return true;
+    }
+
+    const int64_t previousLines = it != entries.end() ? it->second.lines : -1;
+    if (lineStats != nullptr)
+    {
+        lineStats->lines = lines;
+        lineStats->lineDelta = (lines >= 0 && previousLines >= 0) ? lines - previousLines : 0;
+    }
+
+    const bool changed = it == entries.end() || it->second.size != size || it->second.hash != hash;
+    Store(key, size, writeTime, hash, lines);
+    return changed;
+}
+
+void ContentVerifier::Forget(const std::string &key)
+{
+    const auto it = entries.find(key);
+    if (it == entries.end()) return;
+
+    lru.erase(it->second.lruPosition);
+    entries.erase(it);
+}
+
+bool ContentVerifier::HashFile(const std::wstring &fullPath, const uint64_t size, uint64_t &hash, int64_t *lines)
+{
+    // Unity가 아직 쓰는 중이면 공유 위반으로 실패한다 → 변경으로 보고 다음 이벤트에서 다시 본다.
+    const HANDLE file = CreateFileW(fullPath.c_str(), GENERIC_READ,
+                                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    if (size == 0)
+    {
+        CloseHandle(file);
+        hash = Hash(nullptr, 0);
+        if (lines != nullptr) *lines = 0;
+        return true;
+    }
+
+    bool hashed = false;
+    if (const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+    {
+        if (const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(size)))
+        {
+            hash = Hash(view, static_cast<size_t>(size));
+            hashed = true;
+            if (lines != nullptr)
+            {
+                const size_t probe = std::min<size_t>(static_cast<size_t>(size), kBinaryProbeBytes);
+                *lines = std::memchr(view, 0, probe) == nullptr ? CountLines(view, static_cast<size_t>(size)) : -1;
+            }
+            UnmapViewOfFile(view);
+        }
+        CloseHandle(mapping);
+    }
+
+    CloseHandle(file);
+    return hashed;
+}
+
+void ContentVerifier::Store(const std::string &key, const uint64_t size, const uint64_t writeTime, const uint64_t hash,
+                            const int64_t lines)
+{
+    if (const auto it = entries.find(key); it != entries.end())
+    {
+        it->second.size = size;
+        it->second.writeTime = writeTime;
+        it->second.hash = hash;
+        it->second.lines = lines;
+        return;
+    }
+
+    while (entries.size() >= capacity && !lru.empty())
+    {
+        entries.erase(lru.back());
+        lru.pop_back();
+    }
+
+    lru.push_front(key);
+    entries.emplace(key, Entry{size, writeTime, hash, lines, lru.begin()});
+}
@@ -0,0 +1,755 @@
+#include "file_index.h"
+#include "work_stealing_pool.h"
+
+#include <cstddef>
+#include <cstring>
+#include <cwchar>
+#include <iterator>
+
+namespace
+{
+    constexpr uint32_t kIndexMagic = 0x58495457; // "WTIX"
+    constexpr uint32_t kIndexVersion = 3; // 2: Header.savedTime, 3: 디렉토리 시각 제거
+
+    std::wstring Utf8ToWide(const std::string& s)
+    {
+        if (s.empty()) return L"";
+        const int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (len <= 1) return L"";
+        std::wstring w(static_cast<size_t>(len), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), len);
+        w.resize(static_cast<size_t>(len - 1));
+        return w;
+    }
+
+    std::string WideToUtf8(const std::wstring& w)
+    {
+        if (w.empty()) return "";
+        const int len = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                                            nullptr, 0, nullptr, nullptr);
+        if (len <= 0) return "";
+        std::string s(static_cast<size_t>(len), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                            s.data(), len, nullptr, nullptr);
+        return s;
+    }
+
+    uint64_t ToUInt64(const FILETIME& ft)
+    {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    }
+
+    uint64_t ToUInt64(const DWORD high, const DWORD low)
+    {
+        return (static_cast<uint64_t>(high) << 32) | low;
+    }
+
+    /**
+     * 여러 워커가 동시에 후보를 넣는 고정 크기 최근 수정 상위 K 힙.
+     * 가득 찬 뒤에는 힙 최솟값을 atomic 임계값으로 공개해 대부분의 후보를 락 없이 거른다.
+     */
+    class ConcurrentTopK
+    {
+    public:
+        explicit ConcurrentTopK(const size_t capacity) : capacity(capacity) {}
+
+        void Offer(const std::string &path, const uint64_t writeTime, const DWORD action)
+        {
+            if (capacity == 0 || writeTime <= threshold.load(std::memory_order_relaxed)) return;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (heap.size() < capacity)
+            {
+                heap.push_back({path, writeTime, action});
+                std::push_heap(heap.begin(), heap.end(), Newer);
+            }
+            else if (writeTime > heap.front().writeTime)
+            {
+                std::pop_heap(heap.begin(), heap.end(), Newer);
+                heap.back() = {path, writeTime, action};
+                std::push_heap(heap.begin(), heap.end(), Newer);
+            }
+
+            if (heap.size() == capacity)
+            {
+                threshold.store(heap.front().writeTime, std::memory_order_relaxed);
+            }
+        }
+
+        std::vector<FileIndex::Change> TakeSorted()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::sort_heap(heap.begin(), heap.end(), Newer);
+            return std::move(heap);
+        }
+
+    private:
+        // 최소 힙 (front가 가장 오래된 후보) → sort_heap 결과는 최신순
+        static bool Newer(const FileIndex::Change &a, const FileIndex::Change &b)
+        {
+            return a.writeTime > b.writeTime;
+        }
+
+        const size_t capacity;
+        std::atomic<uint64_t> threshold{0};
+        std::mutex mutex;
+        std::vector<FileIndex::Change> heap;
+    };
+
+    bool StartsWith(const std::string_view value, const std::string_view prefix)
+    {
+        return value.size() >= prefix.size() && value.compare(0, prefix.size(), prefix) == 0;
+    }
+}
+
+FileIndex::FileIndex(std::string projectPath, std::shared_ptr<const IgnoreRules> ignoreRules,
+                     std::unordered_set<std::string> extensions) :
+    projectPath(std::move(projectPath)),
+    ignoreRules(std::move(ignoreRules)),
+    extensions(std::move(extensions))
+{
+    rootPath = Utf8ToWide(this->projectPath);
+    std::replace(rootPath.begin(), rootPath.end(), L'/', L'\\');
+    while (!rootPath.empty() && rootPath.back() == L'\\') rootPath.pop_back();
+
+    indexFilePath = IndexFilePathFor(this->projectPath);
+}
+
+FileIndex::~FileIndex()
+{
+    Unmap();
+}
+
+std::wstring FileIndex::IndexFilePathFor(const std::string &projectPath)
+{
+    const std::string base = Config::GetAppDataDir();
+    if (base.empty()) return L"";
+
+    const fs::path dir = fs::path(Utf8ToWide(base)) / L"index";
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return L"";
+
+    // 프로젝트 경로(구분자/대소문자 정규화)의 FNV-1a 64를 파일 이름으로 사용
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char c : projectPath)
+    {
+        const unsigned char normalized = (c == '\\') ? '/' : static_cast<unsigned char>(::tolower(c));
+        hash ^= normalized;
+        hash *= 1099511628211ull;
+    }
+
+    wchar_t name[32];
+    swprintf(name, 32, L"%016llx.idx", static_cast<unsigned long long>(hash));
+    return (dir / name).wstring();
+}
+
+bool FileIndex::Load()
+{
+    loaded = MapFile();
+    if (loaded)
+    {
+        WT_LOG("[FileIndex] Loaded " << fileCount << " file(s), " << dirCount << " dir(s) for " << projectPath);
+    }
+    return loaded;
+}
+
+bool FileIndex::MapFile()
+{
+    Unmap();
+    if (indexFilePath.empty()) return false;
+
+    mappingFile = CreateFileW(indexFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mappingFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(mappingFile, &fileSize) ||
+        fileSize.QuadPart < static_cast<LONGLONG>(sizeof(Header)))
+    {
+        Unmap();
+        return false;
+    }
+
+    mapping = CreateFileMappingW(mappingFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        Unmap();
+        return false;
+    }
+
+    view = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (view == nullptr)
+    {
+        Unmap();
+        return false;
+    }
+
+    // 형식/크기 검증: 손상된 파일은 버리고 빈 인덱스로 시작한다.
+    Header header{};
+    std::memcpy(&header, view, sizeof(header));
+    const uint64_t expectedSize = sizeof(Header) +
+                                  static_cast<uint64_t>(header.fileCount) * sizeof(FileRecord) +
+                                  static_cast<uint64_t>(header.dirCount) * sizeof(DirRecord) +
+                                  header.stringBytes;
+    if (header.magic != kIndexMagic || header.version != kIndexVersion ||
+        expectedSize != static_cast<uint64_t>(fileSize.QuadPart))
+    {
+        WT_ERR("[FileIndex] Discarding invalid index file for " << projectPath);
+        Unmap();
+        return false;
+    }
+
+    files = reinterpret_cast<const FileRecord *>(view + sizeof(Header));
+    dirs = reinterpret_cast<const DirRecord *>(files + header.fileCount);
+    strings = reinterpret_cast<const char *>(dirs + header.dirCount);
+
+    for (uint32_t i = 0; i < header.fileCount; ++i)
+    {
+        if (static_cast<uint64_t>(files[i].pathOffset) + files[i].pathLength > header.stringBytes)
+        {
+            Unmap();
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header.dirCount; ++i)
+    {
+        if (static_cast<uint64_t>(dirs[i].pathOffset) + dirs[i].pathLength > header.stringBytes)
+        {
+            Unmap();
+            return false;
+        }
+    }
+
+    fileCount = header.fileCount;
+    dirCount = header.dirCount;
+    savedTime = header.savedTime;
+    return true;
+}
+
+void FileIndex::Unmap()
+{
+    if (view != nullptr)
+    {
+        UnmapViewOfFile(view);
+        view = nullptr;
+    }
+    if (mapping != nullptr)
+    {
+        CloseHandle(mapping);
+        mapping = nullptr;
+    }
+    if (mappingFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mappingFile);
+        mappingFile = INVALID_HANDLE_VALUE;
+    }
+
+    files = nullptr;
+    dirs = nullptr;
+    strings = nullptr;
+    fileCount = 0;
+    dirCount = 0;
+    savedTime = 0;
+}
+
+bool FileIndex::Save(const bool advanceSavedTime)
+{
+    if (indexFilePath.empty()) return false;
+    if (!dirty)
+    {
+        // 내용은 그대로여도 저장 시각은 갱신해야 다음 실행의 오프라인 구간이 정확하다 (헤더 8바이트만 덮어씀).
+        if (!advanceSavedTime) return true;
+        return view != nullptr && TouchSavedTime();
+    }
+
+    // 매핑 + overlay 병합 (경로는 매핑/overlay 키를 가리키는 view, 파일 교체 전까지 유효)
+    std::vector<std::pair<std::string_view, FileEntry>> mergedFiles;
+    mergedFiles.reserve(fileCount + fileOverlay.size());
+    for (uint32_t i = 0; i < fileCount; ++i)
+    {
+        const std::string_view path = FilePathAt(i);
+        if (fileOverlay.find(std::string(path)) != fileOverlay.end()) continue;
+        mergedFiles.emplace_back(path, FileEntry{files[i].size, files[i].writeTime});
+    }
+    for (const auto &[path, entry] : fileOverlay)
+    {
+        if (entry) mergedFiles.emplace_back(path, *entry);
+    }
+
+    std::vector<std::string_view> mergedDirs;
+    mergedDirs.reserve(dirCount + dirOverlay.size());
+    for (uint32_t i = 0; i < dirCount; ++i)
+    {
+        const std::string_view path = DirPathAt(i);
+        if (dirOverlay.find(std::string(path)) != dirOverlay.end()) continue;
+        mergedDirs.push_back(path);
+    }
+    for (const auto &[path, present] : dirOverlay)
+    {
+        if (present) mergedDirs.push_back(path);
+    }
+
+    const auto byPath = [](const auto &a, const auto &b) { return a.first < b.first; };
+    std::sort(mergedFiles.begin(), mergedFiles.end(), byPath);
+    std::sort(mergedDirs.begin(), mergedDirs.end());
+
+    Header header{};
+    header.magic = kIndexMagic;
+    header.version = kIndexVersion;
+    header.fileCount = static_cast<uint32_t>(mergedFiles.size());
+    header.dirCount = static_cast<uint32_t>(mergedDirs.size());
+
+    FILETIME now{};
+    GetSystemTimeAsFileTime(&now);
+    header.savedTime = advanceSavedTime || savedTime == 0 ? ToUInt64(now) : savedTime;
+
+    std::vector<FileRecord> fileRecords;
+    std::vector<DirRecord> dirRecords;
+    std::string stringData;
+    fileRecords.reserve(mergedFiles.size());
+    dirRecords.reserve(mergedDirs.size());
+
+    for (const auto &[path, entry] : mergedFiles)
+    {
+        fileRecords.push_back({entry.size, entry.writeTime,
+                               static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(path.size())});
+        stringData.append(path);
+    }
+    for (const std::string_view path : mergedDirs)
+    {
+        dirRecords.push_back({static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(path.size())});
+        stringData.append(path);
+    }
+    header.stringBytes = stringData.size();
+
+    const std::wstring tempPath = indexFilePath + L".tmp";
+    {
+        std::ofstream file(fs::path(tempPath), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            WT_ERR("[FileIndex] Failed to open temp index file for " << projectPath);
+            return false;
+        }
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(fileRecords.data()),
+                   static_cast<std::streamsize>(fileRecords.size() * sizeof(FileRecord)));
+        file.write(reinterpret_cast<const char *>(dirRecords.data()),
+                   static_cast<std::streamsize>(dirRecords.size() * sizeof(DirRecord)));
+        file.write(stringData.data(), static_cast<std::streamsize>(stringData.size()));
+        if (!file.good())
+        {
+            WT_ERR("[FileIndex] Failed to write index file for " << projectPath);
+            file.close();
+            DeleteFileW(tempPath.c_str());
+            return false;
+        }
+    }
+
+    // 매핑 중인 파일은 교체할 수 없으므로 먼저 해제한다. 교체 실패 시 기존 파일을 다시 매핑한다.
+    Unmap();
+    if (!MoveFileExW(tempPath.c_str(), indexFilePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        WT_ERR("[FileIndex] Failed to replace index file for " << projectPath << " (Error: " << GetLastError() << ")");
+        DeleteFileW(tempPath.c_str());
+        MapFile();
+        return false;
+    }
+
+    fileOverlay.clear();
+    dirOverlay.clear();
+    dirty = false;
+    MapFile();
+
+    WT_LOG("[FileIndex] Saved " << header.fileCount << " file(s), " << header.dirCount << " dir(s) for " << projectPath);
+    return true;
+}
+
+bool FileIndex::TouchSavedTime()
+{
+    FILETIME now{};
+    GetSystemTimeAsFileTime(&now);
+    const uint64_t value = ToUInt64(now);
+
+    // 매핑 중에는 쓰기로 열 수 없으므로 잠시 해제한다.
+    Unmap();
+    bool written = false;
+    {
+        std::fstream file(fs::path(indexFilePath), std::ios::in | std::ios::out | std::ios::binary);
+        if (file.is_open())
+        {
+            file.seekp(offsetof(Header, savedTime));
+            file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+            written = file.good();
+        }
+    }
+    MapFile();
+    return written;
+}
+
+std::vector<FileIndex::Change> FileIndex::Refresh(const std::atomic<bool> &cancel, const size_t maxChanges,
+                                                  const std::vector<std::string> &scopes, const uint64_t since,
+                                                  const uint64_t until, size_t *changedFiles)
+{
+    // 병렬 구간에서는 인덱스를 읽기만 하고, 결과 반영은 모든 열거가 끝난 뒤 이 스레드에서 한다.
+    WorkStealingPool pool;
+    ConcurrentTopK recent(maxChanges);
+    std::mutex resultsMutex;
+    size_t changed = 0; // resultsMutex
+
+    const auto inScope = [&scopes](const std::string_view path)
+    {
+        return std::any_of(scopes.begin(), scopes.end(), [path](const std::string &scope)
+        {
+            return scope.empty() || path == scope ||
+                   (path.size() > scope.size() && path[scope.size()] == '/' && StartsWith(path, scope));
+        });
+    };
+
+    // 범위 안의 인덱스 디렉토리를 전부 한 번씩 열거한다. 열거 결과(크기/수정 시각)를 인덱스와 비교하므로 파일을 개별 stat 하지 않는다.
+    // 새 디렉토리는 열거를 마친 뒤에 기록한다 (중간 취소로 못 본 디렉토리는 다음에 부모 열거에서 다시 새 디렉토리로 잡힌다).
+    std::vector<std::string> indexedDirs;
+    indexedDirs.reserve(dirCount + dirOverlay.size());
+    for (uint32_t i = 0; i < dirCount; ++i)
+    {
+        const std::string_view path = DirPathAt(i);
+        if (!inScope(path)) continue;
+        std::string key(path);
+        if (dirOverlay.find(key) != dirOverlay.end()) continue;
+        indexedDirs.push_back(std::move(key));
+    }
+    for (const auto &[path, present] : dirOverlay)
+    {
+        if (present && inScope(path)) indexedDirs.push_back(path);
+    }
+
+    // 범위의 시작 디렉토리가 아직 인덱스에 없으면(빈 인덱스의 루트 등) 새 디렉토리로 열거한다.
+    std::vector<std::string> newRoots;
+    for (const auto &scope : scopes)
+    {
+        if (HasDir(scope)) continue;
+        if (std::find(newRoots.begin(), newRoots.end(), scope) == newRoots.end()) newRoots.push_back(scope);
+    }
+
+    // overlay 파일은 부모 디렉토리별로 묶어 둔다 (열거 결과에 없는 파일 = 삭제 판정용).
+    std::unordered_map<std::string, std::vector<std::string>> overlayChildren;
+    for (const auto &[path, entry] : fileOverlay)
+    {
+        if (!entry || !inScope(path)) continue;
+        const size_t slash = path.rfind('/');
+        overlayChildren[slash == std::string::npos ? std::string() : path.substr(0, slash)].push_back(path);
+    }
+
+    struct DirScan
+    {
+        std::string dir;
+        std::vector<std::pair<std::string, FileEntry>> files;   // 새로 생겼거나 바뀐 추적 파일
+        size_t reported = 0;                                    // 그중 수정 시각이 (since, until] 안인 것
+        std::vector<std::string> removedFiles;                  // 인덱스에 있는데 열거에 없는 파일
+    };
+    std::vector<DirScan> scans;
+    std::vector<std::string> removedDirs;
+
+    std::function<void(std::string)> enumerate = [&](std::string dir)
+    {
+        if (!dir.empty() && ignoreRules->IsIgnored(dir, true))
+        {
+            std::lock_guard<std::mutex> lock(resultsMutex);
+            removedDirs.push_back(std::move(dir));
+            return;
+        }
+
+        WIN32_FIND_DATAW data{};
+        const std::wstring pattern = FullPath(dir) + L"\\*";
+        const HANDLE find = FindFirstFileExW(pattern.c_str(), FindExInfoBasic, &data,
+                                             FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+        if (find == INVALID_HANDLE_VALUE)
+        {
+            // 디렉토리가 없어졌으면 하위까지 지운다. 그 밖의 오류(접근 거부 등)는 다음 Refresh에서 다시 본다.
+            const DWORD error = GetLastError();
+            if (error == ERROR_PATH_NOT_FOUND || error == ERROR_FILE_NOT_FOUND || error == ERROR_DIRECTORY)
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                removedDirs.push_back(std::move(dir));
+            }
+            return;
+        }
+
+        DirScan scan{std::move(dir), {}, 0, {}};
+        std::unordered_set<std::string> present; // 열거된 추적 파일 경로
+        do
+        {
+            if (wcscmp(data.cFileName, L".") == 0 || wcscmp(data.cFileName, L"..") == 0) continue;
+
+            const std::string name = WideToUtf8(data.cFileName);
+            std::string relativePath = scan.dir.empty() ? name : scan.dir + "/" + name;
+
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)
+            {
+                // junction/symlink는 따라가지 않는다 (순환 방지)
+                if ((data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) continue;
+                if (ignoreRules->IsIgnored(relativePath, true)) continue;
+
+                // 인덱스에 있는 하위 디렉토리는 이미 자기 작업으로 열거된다. 새 디렉토리만 이어서 내려간다.
+                if (!HasDir(relativePath))
+                {
+                    pool.Spawn([&enumerate, path = std::move(relativePath)]() mutable
+                    {
+                        enumerate(std::move(path));
+                    });
+                }
+                continue;
+            }
+
+            if (!IsTracked(relativePath)) continue;
+
+            const FileEntry current{ToUInt64(data.nFileSizeHigh, data.nFileSizeLow), ToUInt64(data.ftLastWriteTime)};
+            const std::optional<FileEntry> stored = FindFile(relativePath);
+            if (!stored || stored->size != current.size || stored->writeTime != current.writeTime)
+            {
+                // 구간 밖 수정(복원된 옛 파일, 감시 시작 이후 수정 등)은 인덱스에만 반영하고 상위 K 자리를 차지하지 않는다.
+                if (current.writeTime > since && current.writeTime <= until)
+                {
+                    recent.Offer(relativePath, current.writeTime, stored ? FILE_ACTION_MODIFIED : FILE_ACTION_ADDED);
+                    ++scan.reported;
+                }
+                scan.files.emplace_back(relativePath, current);
+            }
+            present.insert(std::move(relativePath));
+        } while (FindNextFileW(find, &data));
+
+        FindClose(find);
+
+        // 이 디렉토리 바로 아래의 인덱스 파일 중 열거에 없던 것은 삭제됐다 (무시 규칙/확장자가 바뀐 경우 포함).
+        // 스냅샷은 경로 정렬이므로 하위 디렉토리 구간은 통째로 건너뛴다 ('/' 다음 글자 '0'으로 lower_bound).
+        const std::string prefix = scan.dir.empty() ? std::string() : scan.dir + "/";
+        for (uint32_t i = LowerBoundFile(prefix); i < fileCount && StartsWith(FilePathAt(i), prefix);)
+        {
+            const std::string_view path = FilePathAt(i);
+            if (const size_t slash = path.find('/', prefix.size()); slash != std::string_view::npos)
+            {
+                std::string next(path.substr(0, slash));
+                next += static_cast<char>('/' + 1);
+                i = LowerBoundFile(next);
+                continue;
+            }
+
+            std::string key(path);
+            if (fileOverlay.find(key) == fileOverlay.end() && present.find(key) == present.end())
+            {
+                scan.removedFiles.push_back(std::move(key));
+            }
+            ++i;
+        }
+        if (const auto it = overlayChildren.find(scan.dir); it != overlayChildren.end())
+        {
+            for (const auto &path : it->second)
+            {
+                if (present.find(path) == present.end()) scan.removedFiles.push_back(path);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(resultsMutex);
+        changed += scan.reported;
+        scans.push_back(std::move(scan));
+    };
+
+    std::vector<WorkStealingPool::Task> tasks;
+    tasks.reserve(indexedDirs.size() + newRoots.size());
+    for (auto &dir : indexedDirs)
+    {
+        tasks.emplace_back([&enumerate, dir = std::move(dir)]() mutable { enumerate(std::move(dir)); });
+    }
+    for (auto &dir : newRoots)
+    {
+        tasks.emplace_back([&enumerate, dir = std::move(dir)]() mutable { enumerate(std::move(dir)); });
+    }
+    pool.Run(std::move(tasks), cancel);
+
+    for (const auto &path : removedDirs)
+    {
+        EraseDirTree(path);
+    }
+
+    // 열거를 마친 디렉토리만 반영한다.
+    for (const auto &scan : scans)
+    {
+        for (const auto &[path, entry] : scan.files)
+        {
+            SetFile(path, entry);
+        }
+        for (const auto &path : scan.removedFiles)
+        {
+            EraseFile(path);
+        }
+        AddDir(scan.dir);
+    }
+
+    if (changedFiles != nullptr) *changedFiles = changed;
+    std::vector<Change> changes = recent.TakeSorted();
+    WT_LOG("[FileIndex] Refreshed " << projectPath << " with " << pool.WorkerCount() << " worker(s): "
+           << scans.size() << " dir(s) enumerated, " << FileCount() << " file(s) indexed");
+    return changes;
+}
+
+void FileIndex::UpdateFile(const std::string &relativePath)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data{};
+    if (!GetFileAttributesExW(FullPath(relativePath).c_str(), GetFileExInfoStandard, &data))
+    {
+        EraseFile(relativePath);
+        return;
+    }
+    if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) return;
+
+    SetFile(relativePath, FileEntry{ToUInt64(data.nFileSizeHigh, data.nFileSizeLow), ToUInt64(data.ftLastWriteTime)});
+}
+
+void FileIndex::RemovePath(const std::string &relativePath)
+{
+    if (FindFile(relativePath))
+    {
+        EraseFile(relativePath);
+    }
+    else if (HasDir(relativePath))
+    {
+        EraseDirTree(relativePath);
+    }
+}
+
+size_t FileIndex::FileCount() const
+{
+    size_t count = fileCount;
+    for (const auto &[path, entry] : fileOverlay)
+    {
+        const uint32_t index = LowerBoundFile(path);
+        const bool inSnapshot = index < fileCount && FilePathAt(index) == path;
+        if (inSnapshot && !entry) --count;
+        else if (!inSnapshot && entry) ++count;
+    }
+    return count;
+}
+
+std::string_view FileIndex::FilePathAt(const uint32_t index) const
+{
+    return {strings + files[index].pathOffset, files[index].pathLength};
+}
+
+std::string_view FileIndex::DirPathAt(const uint32_t index) const
+{
+    return {strings + dirs[index].pathOffset, dirs[index].pathLength};
+}
+
+uint32_t FileIndex::LowerBoundFile(const std::string_view path) const
+{
+    uint32_t low = 0, high = fileCount;
+    while (low < high)
+    {
+        const uint32_t mid = low + (high - low) / 2;
+        if (FilePathAt(mid) < path) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+uint32_t FileIndex::LowerBoundDir(const std::string_view path) const
+{
+    uint32_t low = 0, high = dirCount;
+    while (low < high)
+    {
+        const uint32_t mid = low + (high - low) / 2;
+        if (DirPathAt(mid) < path) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+std::optional<FileIndex::FileEntry> FileIndex::FindFile(const std::string &relativePath) const
+{
+    if (const auto it = fileOverlay.find(relativePath); it != fileOverlay.end()) return it->second;
+
+    const uint32_t low = LowerBoundFile(relativePath);
+    if (low < fileCount && FilePathAt(low) == relativePath)
+    {
+        return FileEntry{files[low].size, files[low].writeTime};
+    }
+    return std::nullopt;
+}
+
+bool FileIndex::HasDir(const std::string &relativePath) const
+{
+    if (const auto it = dirOverlay.find(relativePath); it != dirOverlay.end()) return it->second;
+
+    const uint32_t low = LowerBoundDir(relativePath);
+    return low < dirCount && DirPathAt(low) == relativePath;
+}
+
+void FileIndex::SetFile(const std::string &relativePath, const FileEntry &entry)
+{
+    fileOverlay[relativePath] = entry;
+    dirty = true;
+}
+
+void FileIndex::AddDir(const std::string &relativePath)
+{
+    if (HasDir(relativePath)) return;
+    dirOverlay[relativePath] = true;
+    dirty = true;
+}
+
+void FileIndex::EraseFile(const std::string &relativePath)
+{
+    if (!FindFile(relativePath)) return;
+    fileOverlay[relativePath] = std::nullopt;
+    dirty = true;
+}
+
+void FileIndex::EraseDirTree(const std::string &relativePath)
+{
+    const std::string prefix = relativePath.empty() ? std::string() : relativePath + "/";
+
+    dirOverlay[relativePath] = false;
+    dirty = true;
+
+    // 스냅샷은 경로 정렬이므로 같은 접두어의 레코드는 연속 구간이다.
+    for (uint32_t i = LowerBoundDir(prefix); i < dirCount && StartsWith(DirPathAt(i), prefix); ++i)
+    {
+        dirOverlay[std::string(DirPathAt(i))] = false;
+    }
+
+    for (uint32_t i = LowerBoundFile(prefix); i < fileCount && StartsWith(FilePathAt(i), prefix); ++i)
+    {
+        fileOverlay[std::string(FilePathAt(i))] = std::nullopt;
+    }
+
+    for (auto &[path, present] : dirOverlay)
+    {
+        if (StartsWith(path, prefix)) present = false;
+    }
+    for (auto &[path, entry] : fileOverlay)
+    {
+        if (StartsWith(path, prefix)) entry = std::nullopt;
+    }
+}
+
+bool FileIndex::IsTracked(const std::string &relativePath) const
+{
+    const size_t dotPos = relativePath.find_last_of('.');
+    if (dotPos == std::string::npos) return false;
+
+    std::string extension = relativePath.substr(dotPos);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](const unsigned char c) { return static_cast<char>(::tolower(c)); });
+    if (extensions.find(extension) == extensions.end()) return false;
+
+    return !ignoreRules->IsIgnored(relativePath, false);
+}
+
+std::wstring FileIndex::FullPath(const std::string &relativePath) const
+{
+    if (relativePath.empty()) return rootPath;
+
+    std::wstring path = rootPath + L"\\" + Utf8ToWide(relativePath);
+    std::replace(path.begin(), path.end(), L'/', L'\\');
+    return path;
+}
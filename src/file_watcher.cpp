@@ -1,11 +1,39 @@
 #include "file_watcher.h"
 #include "app_registry.h"
+#include <iterator>
 #include <utility>
 #include <system_error>
 
 namespace
 {
-    constexpr size_t kMaxPendingEvents = 1024;
+    // 링이 가득 찬 동안 감시 스레드에 보류할 수 있는 최대 이벤트 수. 넘으면 오래된 절반을 버린다.
+    constexpr size_t kMaxStagedEvents = 1024;
+    // 감시 중지된 프로젝트에서 넘겨받은 미처리 이벤트 상한
+    constexpr size_t kMaxOrphanedEvents = 1024;
+    // 콜백 1회에 넘기는 최대 이벤트 수 (모든 링 용량 합보다 작아도 예산 안에서 반복 호출된다)
+    constexpr size_t kMaxDrainBatch = 4096;
+    // Unity는 저장 1회에 같은 파일을 여러 번 쓴다. 이 윈도우 안의 이벤트는 경로별 1건으로 합친다.
+    constexpr auto kCoalesceWindow = std::chrono::milliseconds(300);
+    // 오버플로 복구 시 합성 이벤트로 낼 최근 수정 파일 수
+    constexpr size_t kMaxSyntheticEvents = 128;
+    // 감시 시작 시 오프라인 동안의 변경으로 소급 발행할 최대 이벤트 수 (heartbeat 큐 256 안쪽)
+    constexpr size_t kMaxCatchUpEvents = 128;
+    // 오프라인 동안 인덱스의 이 비율 이상(그리고 최소 개수 이상)이 바뀌었으면 git pull/패키지 복원/임포트 같은
+    // 도구 작업으로 보고 소급하지 않는다. 사람이 에디터 없이 손댄 파일은 이보다 훨씬 적다.
+    constexpr double kCatchUpBulkFraction = 0.1;
+    constexpr size_t kCatchUpBulkMinFiles = 200;
+    // 첫 스캔 결과가 오기 전까지 기억할 실시간 경로 상한
+    constexpr size_t kMaxLivePaths = 4096;
+    // 스캔이 길어져 미뤄 둔 인덱스 갱신이 이만큼 쌓이면 버리고 스캔을 한 번 더 돈다.
+    constexpr size_t kMaxDeferredIndexUpdates = 4096;
+
+    // 임포트 폭주(storm) 판정: 1초 창에 추적 대상 이벤트가 진입 기준 이상이면 storm,
+    // 해제 기준 미만인 창이 연속 kStormExitQuietWindows개면 해제. storm 중에는 폴더별 최신 1건만 주기적으로 내보낸다.
+    constexpr auto kStormRateWindow = std::chrono::seconds(1);
+    constexpr size_t kStormEnterEventsPerWindow = 200;
+    constexpr size_t kStormExitEventsPerWindow = 20;
+    constexpr size_t kStormExitQuietWindows = 5;
+    constexpr auto kStormSampleInterval = std::chrono::seconds(10);
 
     std::wstring Utf8ToWide(const std::string& s)
     {
@@ -29,6 +57,94 @@ namespace
                             s.data(), len, nullptr, nullptr);
         return s;
     }
+
+    // JSON 문자열 리터럴 하나를 읽는다 (pos는 여는 따옴표). 실패하면 false.
+    bool ReadJsonString(const std::string &text, size_t &pos, std::string &out)
+    {
+        if (pos >= text.size() || text[pos] != '"') return false;
+        out.clear();
+        for (++pos; pos < text.size(); ++pos)
+        {
+            const char c = text[pos];
+            if (c == '"')
+            {
+                ++pos;
+                return true;
+            }
+            if (c == '\\' && pos + 1 < text.size())
+            {
+                // 경로에 나올 수 있는 이스케이프만 해석한다 (\uXXXX 등은 그대로 둔다)
+                const char escaped = text[++pos];
+                if (escaped != '/' && escaped != '\\' && escaped != '"') out += '\\';
+                out += escaped;
+                continue;
+            }
+            out += c;
+        }
+        return false;
+    }
+
+    void SkipJsonSpace(const std::string &text, size_t &pos)
+    {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    /**
+     * Unity Packages/manifest.json의 "dependencies"에서 "file:" 로컬 패키지 폴더 경로를 모은다.
+     * 상대 경로는 manifest가 있는 폴더 기준이다. tarball(.tgz) 등 폴더가 아닌 것은 뺀다.
+     */
+    std::vector<fs::path> ReadLocalPackageDirs(const fs::path &manifestPath)
+    {
+        std::vector<fs::path> dirs;
+
+        std::ifstream file(manifestPath, std::ios::binary);
+        if (!file) return dirs;
+        const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        size_t pos = text.find("\"dependencies\"");
+        if (pos == std::string::npos) return dirs;
+        pos = text.find('{', pos);
+        if (pos == std::string::npos) return dirs;
+        ++pos;
+
+        std::string name;
+        std::string value;
+        while (true)
+        {
+            SkipJsonSpace(text, pos);
+            if (pos >= text.size() || text[pos] == '}') break;
+            if (!ReadJsonString(text, pos, name)) break;
+            SkipJsonSpace(text, pos);
+            if (pos >= text.size() || text[pos] != ':') break;
+            ++pos;
+            SkipJsonSpace(text, pos);
+            if (!ReadJsonString(text, pos, value)) break; // 의존성 값은 항상 문자열 (버전/URL/file:)
+            SkipJsonSpace(text, pos);
+            if (pos < text.size() && text[pos] == ',') ++pos;
+
+            if (value.compare(0, 5, "file:") != 0) continue;
+
+            fs::path dir(Utf8ToWide(value.substr(5)));
+            if (dir.is_relative()) dir = manifestPath.parent_path() / dir;
+            dir = dir.lexically_normal();
+
+            std::error_code ec;
+            if (fs::is_directory(dir, ec)) dirs.push_back(std::move(dir));
+        }
+
+        return dirs;
+    }
+
+    std::chrono::system_clock::time_point FileTimeToTimePoint(const uint64_t fileTime)
+    {
+        // FILETIME(1601-01-01 기준 100ns) → Unix epoch
+        constexpr uint64_t kUnixEpochFileTime = 116444736000000000ull;
+        if (fileTime <= kUnixEpochFileTime) return std::chrono::system_clock::time_point{};
+
+        const auto sinceEpoch = std::chrono::microseconds((fileTime - kUnixEpochFileTime) / 10);
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch));
+    }
 }
 
 FileWatcher::FileWatcher()
@@ -42,7 +158,7 @@ FileWatcher::~FileWatcher()
     WT_LOG("[FileWatcher] Destroyed");
 }
 
-void FileWatcher::SetChangeCallback(std::function<void(const FileChangeEvent &)> callback)
+void FileWatcher::SetChangeCallback(ChangeBatchCallback callback)
 {
     changeCallback = std::move(callback);
     WT_LOG("[FileWatcher] Change callback set");
@@ -54,6 +170,17 @@ void FileWatcher::SetNotifyCallback(std::function<void()> callback)
     WT_LOG("[FileWatcher] Notify callback set");
 }
 
+void FileWatcher::SetMetadataCallback(std::function<void(const std::string &projectPath)> callback)
+{
+    metadataCallback = std::move(callback);
+}
+
+void FileWatcher::SetContentVerification(const bool enabled)
+{
+    verifyContent.store(enabled);
+    WT_LOG("[FileWatcher] Content verification " << (enabled ? "enabled" : "disabled"));
+}
+
 bool FileWatcher::StartWatching(const std::string &appId, const std::string &projectPath,
                                 const std::string &projectName, const std::string &editorVersion)
 {
@@ -62,7 +189,7 @@ bool FileWatcher::StartWatching(const std::string &appId, const std::string &pro
     // 이미 감시 중인지 확인
     for (const auto &project: watchedProjects)
     {
-        if (project->projectPath == projectPath) return true;
+        if (project->context->projectPath == projectPath) return true;
     }
 
     if (!fs::exists(Utf8ToWide(projectPath)))
@@ -72,20 +199,23 @@ bool FileWatcher::StartWatching(const std::string &appId, const std::string &pro
     }
 
     auto project = std::make_unique<WatchedProject>();
-    if (project->stopEvent == nullptr || project->ioEvent == nullptr)
+    if (project->stopEvent == nullptr || project->scanEvent == nullptr)
     {
         WT_ERR("[FileWatcher] Failed to create watcher events for: " << projectPath);
         return false;
     }
 
-    project->appId = appId;
-    project->projectPath = projectPath;
-    project->projectName = projectName;
-    project->editorVersion = editorVersion;
+    std::string entityPrefix = projectPath;
+    std::replace(entityPrefix.begin(), entityPrefix.end(), '\\', '/');
+    entityPrefix += '/';
+    project->context = std::make_shared<const ProjectContext>(
+        ProjectContext{appId, projectPath, projectName, editorVersion, std::move(entityPrefix),
+                       std::make_shared<GitBranchResolver>(projectPath)});
     project->shouldStop = false;
 
     // 앱 정의의 확장자 필터를 소문자 set으로 적재 (워커 스레드는 immutable 정의만 읽음)
-    if (const AppDefinition *def = AppRegistry::FindById(appId))
+    const AppDefinition *def = AppRegistry::FindById(appId);
+    if (def != nullptr)
     {
         for (const auto &ext : def->fileExtensions)
         {
@@ -94,31 +224,35 @@ bool FileWatcher::StartWatching(const std::string &appId, const std::string &pro
                            [](const unsigned char c) { return static_cast<char>(::tolower(c)); });
             project->extensions.insert(std::move(lower));
         }
+        for (const auto &ext : def->lineCountExtensions)
+        {
+            std::string lower = ext;
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](const unsigned char c) { return static_cast<char>(::tolower(c)); });
+            project->lineCountExtensions.insert(std::move(lower));
+        }
+        project->metadataFile = def->metadataFile;
     }
 
-    ZeroMemory(&project->overlapped, sizeof(OVERLAPPED));
-    project->overlapped.hEvent = project->ioEvent;
-    ZeroMemory(project->buffer, sizeof(project->buffer));
+    // 무시 규칙은 감시 시작 시 1회 컴파일한다 (ignore 파일 수정은 다음 감시 시작부터 반영).
+    project->ignoreRules = IgnoreRules::LoadForProject(projectPath);
+    project->packageIgnoreRules = IgnoreRules::Defaults();
+    project->fileIndex = std::make_unique<FileIndex>(projectPath, project->ignoreRules, project->extensions);
 
-    // 한글/비ASCII 경로 보존을 위해 wide path로 디렉토리 핸들 오픈.
-    project->directoryHandle = CreateFileW(
-        Utf8ToWide(projectPath).c_str(),
-        FILE_LIST_DIRECTORY,
-        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
-        nullptr,
-        OPEN_EXISTING,
-        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
-        nullptr
-    );
+    // 이 시각 이후의 수정은 실시간 감시가 본다 (소급 구간의 끝).
+    FILETIME now{};
+    GetSystemTimeAsFileTime(&now);
+    project->watchStartTime = (static_cast<uint64_t>(now.dwHighDateTime) << 32) | now.dwLowDateTime;
 
-    if (project->directoryHandle == INVALID_HANDLE_VALUE)
+    if (project->inbox->event == nullptr || !SubscribeWatchRoots(project.get(), def))
     {
-        const DWORD error = GetLastError();
-        WT_ERR("[FileWatcher] Failed to open directory: " << projectPath << " (Error: " << error << ")");
+        WT_ERR("[FileWatcher] Failed to open directory: " << projectPath);
+        UnsubscribeWatchRoots(project.get());
         return false;
     }
 
-    WT_LOG("[FileWatcher] Started watching: " << projectName << " at " << projectPath);
+    WT_LOG("[FileWatcher] Started watching: " << projectName << " at " << projectPath
+           << " (" << project->roots.size() << " root(s))");
 
     WatchedProject *projectPtr = project.get();
     try
@@ -128,6 +262,7 @@ bool FileWatcher::StartWatching(const std::string &appId, const std::string &pro
     catch (const std::system_error &e)
     {
         WT_ERR("[FileWatcher] Failed to start watch thread for " << projectName << ": " << e.what());
+        UnsubscribeWatchRoots(project.get());
         return false;
     }
 
@@ -136,286 +271,772 @@ bool FileWatcher::StartWatching(const std::string &appId, const std::string &pro
     return true;
 }
 
+bool FileWatcher::SubscribeWatchRoots(WatchedProject *project, const AppDefinition *def)
+{
+    struct Candidate {
+        std::wstring directory;
+        std::string prefix;
+        bool external;
+        std::wstring canonical;
+    };
+    std::vector<Candidate> candidates;
+
+    const fs::path base(Utf8ToWide(project->context->projectPath));
+    if (def != nullptr)
+    {
+        for (const auto &subdir : def->watchRoots)
+        {
+            const fs::path dir = base / Utf8ToWide(subdir);
+            std::error_code ec;
+            if (!fs::is_directory(dir, ec)) continue; // Packages 등이 없는 프로젝트도 있다
+
+            std::string prefix = subdir;
+            std::replace(prefix.begin(), prefix.end(), '\\', '/');
+            candidates.push_back(Candidate{dir.wstring(), prefix + "/", false, std::wstring()});
+        }
+
+        if (!candidates.empty() && !def->packageManifest.empty())
+        {
+            for (const auto &dir : ReadLocalPackageDirs(base / Utf8ToWide(def->packageManifest)))
+            {
+                std::string prefix = WideToUtf8(dir.generic_wstring());
+                if (!prefix.empty() && prefix.back() != '/') prefix += '/';
+                candidates.push_back(Candidate{dir.wstring(), std::move(prefix), true, std::wstring()});
+            }
+        }
+    }
+
+    // 좁힐 폴더가 없으면(정의 없음, 또는 하나도 존재하지 않음) 예전처럼 루트 전체를 감시한다.
+    if (candidates.empty())
+    {
+        candidates.push_back(Candidate{base.wstring(), std::string(), false, std::wstring()});
+    }
+
+    // 프로젝트 안에 있는 file: 패키지처럼 다른 후보에 포함되는 폴더는 빼서 같은 파일이 두 번 오지 않게 한다.
+    for (auto &candidate : candidates)
+    {
+        candidate.canonical = WatchRegistry::CanonicalPath(candidate.directory);
+    }
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (candidates[i].canonical.empty()) continue;
+
+        bool covered = false;
+        for (size_t j = 0; j < candidates.size() && !covered; ++j)
+        {
+            if (i == j || candidates[j].canonical.empty()) continue;
+            // 같은 폴더가 두 번이면 앞의 것을 남긴다
+            covered = WatchRegistry::IsWithin(candidates[i].canonical, candidates[j].canonical) &&
+                      (candidates[i].canonical != candidates[j].canonical || j < i);
+        }
+        if (covered) continue;
+
+        const size_t tag = project->roots.size();
+        const auto subscription = watchRegistry.Subscribe(candidates[i].directory, project->inbox, tag);
+        if (subscription == 0) continue;
+
+        project->roots.push_back(WatchRoot{candidates[i].prefix, candidates[i].external, subscription});
+        if (candidates[i].external)
+        {
+            WT_LOG("[FileWatcher] Watching local package: " << candidates[i].prefix);
+        }
+    }
+
+    if (project->roots.empty()) return false;
+
+    // 브랜치 전환(HEAD 변경)만 알면 되므로 HEAD가 있는 디렉토리를 비재귀로 따로 구독한다
+    // (objects/, logs/ 등 fetch·gc·commit 때 쏟아지는 하위 변경은 받지 않는다). 실패해도 감시는 계속한다.
+    if (const auto &git = project->context->git; git != nullptr && git->IsRepository())
+    {
+        project->gitHeadSubscription = watchRegistry.Subscribe(git->HeadDirectory().wstring(), project->inbox,
+                                                               kGitHeadTag, false);
+    }
+    return true;
+}
+
+void FileWatcher::UnsubscribeWatchRoots(WatchedProject *project)
+{
+    for (auto &root : project->roots)
+    {
+        watchRegistry.Unsubscribe(root.subscription);
+        root.subscription = 0;
+    }
+    if (project->gitHeadSubscription != 0)
+    {
+        watchRegistry.Unsubscribe(project->gitHeadSubscription);
+        project->gitHeadSubscription = 0;
+    }
+}
+
 void FileWatcher::WatchProjectThread(WatchedProject *project)
 {
     if (project == nullptr ||
-        project->directoryHandle == nullptr ||
-        project->directoryHandle == INVALID_HANDLE_VALUE ||
+        project->roots.empty() ||
         project->stopEvent == nullptr ||
-        project->ioEvent == nullptr)
+        project->scanEvent == nullptr)
     {
         WT_ERR("[FileWatcher] Invalid watch project state, thread exit");
         return;
     }
 
-    WT_LOG("[FileWatcher] Watch thread started for: " << project->projectName);
+    WT_LOG("[FileWatcher] Watch thread started for: " << project->context->projectName);
+
+    // 저장된 인덱스를 재사용하고 꺼져 있던 동안의 차이만 반영한다 (없으면 이번에 1회 전체 열거).
+    // 스캔 스레드에서 돈다. 그동안 감시는 바로 시작한다.
+    RequestProjectScan(project, true);
 
+    const HANDLE waitHandles[3] = {
+        project->stopEvent,
+        project->scanEvent,
+        project->inbox->event
+    };
+
+    std::vector<WatchInbox::Notification> notifications;
     while (!project->shouldStop)
     {
-        DWORD bytesReturned = 0;
-        ZeroMemory(&project->overlapped, sizeof(OVERLAPPED));
-        project->overlapped.hEvent = project->ioEvent;
-        ResetEvent(project->ioEvent);
-
-        const BOOL result = ReadDirectoryChangesW(
-            project->directoryHandle,
-            project->buffer,
-            sizeof(project->buffer),
-            TRUE, // 하위 디렉토리 포함 (재귀)
-            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_FILE_NAME,
-            &bytesReturned,
-            &project->overlapped,
-            nullptr
-        );
-
-        if (!result)
-        {
-            const DWORD error = GetLastError();
-            if (error == ERROR_NOTIFY_ENUM_DIR)
-            {
-                // 버퍼 오버플로(대량 변경): 개별 이벤트 유실. 재발급으로 계속 감시.
-                WT_ERR("[FileWatcher] Notify buffer overflow for " << project->projectName << ", continuing");
-                QueueSyntheticProjectScan(project);
-                continue;
-            }
-            if (error != ERROR_IO_PENDING)
-            {
-                WT_ERR("[FileWatcher] ReadDirectoryChangesW failed for " << project->projectName << " (Error: " << error << ")");
-                break;
-            }
+        // staged 이벤트가 있으면 코얼레싱 윈도우 만료 시점까지만 대기하고, 만료되면 flush 후 다시 대기.
+        const DWORD timeout = StagedFlushTimeout(project);
+        if (timeout == 0)
+        {
+            FlushStagedEvents(project);
+            continue;
         }
-        else
+
+        const DWORD waitResult = WaitForMultipleObjects(3, waitHandles, FALSE, timeout);
+        if (waitResult == WAIT_TIMEOUT)
         {
-            // 드물게 동기 완료될 수 있으므로 즉시 처리
-            if (bytesReturned > 0)
-            {
-                ProcessFileChanges(project->buffer, bytesReturned, project);
-                continue;
-            }
+            FlushStagedEvents(project);
+            continue;
+        }
+        if (waitResult == WAIT_OBJECT_0)
+        {
+            WT_LOG("[FileWatcher] Stop event received for: " << project->context->projectName);
+            break;
+        }
+        if (waitResult == WAIT_OBJECT_0 + 1)
+        {
+            // 스캔 결과는 알림 대기 중에도 받아 적재한다.
+            QueueScanResults(project);
+            continue;
+        }
+        if (waitResult != WAIT_OBJECT_0 + 2)
+        {
+            WT_ERR("[FileWatcher] WaitForMultipleObjects failed for " << project->context->projectName << " (Error: " << GetLastError() << ")");
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(project->inbox->mutex);
+            notifications.swap(project->inbox->items);
         }
+        ProcessFileChanges(notifications, project);
+        notifications.clear();
+    }
 
-        const HANDLE waitHandles[2] = {
-            project->ioEvent,
-            project->stopEvent
-        };
+    // 구독을 먼저 끊어 더 이상 알림이 들어오지 않게 한다.
+    UnsubscribeWatchRoots(project);
 
-        const DWORD waitResult = WaitForMultipleObjects(2, waitHandles, FALSE, INFINITE);
+    // storm 중 모아 둔 샘플도 종료 전에 내보낸다.
+    project->stormNextEmit = std::chrono::steady_clock::time_point{};
+    FlushStagedEvents(project);
 
-        switch (waitResult)
+    // 오류로 빠져나온 경우에도 진행 중인 스캔을 취소하고 기다린 뒤 인덱스를 저장한다.
+    project->shouldStop = true;
+    if (project->scanThread.joinable())
+    {
+        project->scanThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(project->indexMutex);
+        for (const auto &[path, removed] : project->deferredIndexUpdates)
         {
-            case WAIT_OBJECT_0: // ioEvent 신호 (I/O 완료)
+            if (removed) project->fileIndex->RemovePath(path);
+            else project->fileIndex->UpdateFile(path);
+        }
+        project->deferredIndexUpdates.clear();
+        project->fileIndex->Save();
+    }
+    WT_LOG("[FileWatcher] Watch thread stopped for: " << project->context->projectName);
+}
+
+void FileWatcher::QueueFileEvent(WatchedProject *project, const std::string &relativePath, const DWORD action,
+                                 const std::chrono::system_clock::time_point timestamp)
+{
+    if (project == nullptr) return;
+
+    // 같은 경로는 최신 action/시각만 남긴다 (ADDED → MODIFIED x N → 1건).
+    if (const auto it = project->stagedIndex.find(relativePath); it != project->stagedIndex.end())
+    {
+        FileChangeEvent &staged = project->stagedEvents[it->second];
+        staged.action = action;
+        staged.timestamp = std::max(staged.timestamp, timestamp);
+        return;
+    }
+
+    if (project->stagedEvents.empty())
+    {
+        project->stagedSince = std::chrono::steady_clock::now();
+    }
+
+    // 프로젝트 문자열은 context 공유로 대신하고, 이벤트마다 갖는 문자열은 상대 경로 하나뿐이다.
+    FileChangeEvent event;
+    event.context = project->context;
+    event.relativePath = relativePath;
+    event.action = action;
+    event.timestamp = timestamp;
+
+    project->stagedIndex.emplace(relativePath, project->stagedEvents.size());
+    project->stagedEvents.emplace_back(std::move(event));
+
+    // 서로 다른 경로가 한도를 넘게 쌓이면 윈도우를 기다리지 않고 넘긴다.
+    if (project->stagedEvents.size() >= kMaxStagedEvents)
+    {
+        FlushStagedEvents(project);
+    }
+}
+
+void FileWatcher::DropStagedEvent(WatchedProject *project, const std::string &fileName)
+{
+    if (project == nullptr) return;
+
+    const auto it = project->stagedIndex.find(fileName);
+    if (it == project->stagedIndex.end()) return;
+
+    // 마지막 원소를 빈 자리로 옮겨 O(1) 제거
+    const size_t index = it->second;
+    project->stagedIndex.erase(it);
+    if (index + 1 != project->stagedEvents.size())
+    {
+        project->stagedEvents[index] = std::move(project->stagedEvents.back());
+        project->stagedIndex[project->stagedEvents[index].relativePath] = index;
+    }
+    project->stagedEvents.pop_back();
+}
+
+void FileWatcher::FlushStagedEvents(WatchedProject *project)
+{
+    if (project == nullptr) return;
+    if (project->stagedEvents.empty() && project->readyEvents.empty() &&
+        !project->inStorm.load(std::memory_order_relaxed)) return;
+
+    // 코얼레싱이 끝난 경로당 1회만 stat 해서 인덱스를 갱신한다. storm 중에도 인덱스는 모든 경로를 반영한다.
+    for (const auto &event : project->stagedEvents)
+    {
+        if (event.IsExternal()) continue; // 로컬 패키지는 프로젝트 인덱스 대상이 아니다
+        const bool removed = event.action == FILE_ACTION_REMOVED || event.action == FILE_ACTION_RENAMED_OLD_NAME;
+        project->deferredIndexUpdates.emplace_back(event.relativePath, removed);
+    }
+    SyncFileIndex(project);
+
+    // storm 중에는 폴더별 대표 이벤트만 모아 두었다가 샘플 주기마다 내보낸다.
+    if (const auto now = std::chrono::steady_clock::now(); UpdateStormState(project, now))
+    {
+        SampleStagedEvents(project);
+        if (now >= project->stormNextEmit)
+        {
+            project->stormNextEmit = now + kStormSampleInterval;
+            for (auto &[folder, event] : project->stormSamples)
             {
-                if (GetOverlappedResult(project->directoryHandle, &project->overlapped, &bytesReturned, FALSE))
-                {
-                    if (bytesReturned > 0)
-                        ProcessFileChanges(project->buffer, bytesReturned, project);
-                    else
-                    {
-                        WT_ERR("[FileWatcher] Notify buffer overflow (0 bytes) for " << project->projectName);
-                        QueueSyntheticProjectScan(project);
-                    }
-                }
-                else
+                project->stagedEvents.emplace_back(std::move(event));
+            }
+            project->stormSamples.clear();
+            RebuildStagedIndex(project);
+        }
+    }
+
+    // 리임포트/도메인 리로드의 "같은 내용 재저장"은 쓰기로 치지 않는다. 새 파일(ADDED 등)은 캐시만 채운다.
+    // 텍스트 에셋은 같은 매핑에서 줄 수를 세어 이벤트에 싣는다 (내용 확인을 꺼도 센다).
+    const bool verify = verifyContent.load();
+    if (!project->stagedEvents.empty() && (verify || !project->lineCountExtensions.empty()))
+    {
+        size_t skipped = 0;
+        size_t kept = 0;
+        auto &events = project->stagedEvents;
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            FileChangeEvent &event = events[i];
+            if (event.action == FILE_ACTION_REMOVED || event.action == FILE_ACTION_RENAMED_OLD_NAME)
+            {
+                project->contentVerifier.Forget(event.relativePath);
+            }
+            else
+            {
+                const bool countLines = IsTrackedFile(event.relativePath, project->lineCountExtensions);
+                if (verify || countLines)
                 {
-                    if (const DWORD error = GetLastError(); error != ERROR_OPERATION_ABORTED && error != ERROR_IO_INCOMPLETE)
-                    {
-                        WT_ERR("[FileWatcher] GetOverlappedResult failed for " << project->projectName << " (Error: " << error << ")");
-                    }
-                    if (project->shouldStop)
+                    ContentVerifier::LineStats lineStats;
+                    const bool changed = project->contentVerifier.HasContentChanged(
+                        event.relativePath, Utf8ToWide(event.FullPath()), countLines ? &lineStats : nullptr);
+                    event.lines = lineStats.lines;
+                    event.lineDelta = lineStats.lineDelta;
+                    if (verify && !changed && event.action == FILE_ACTION_MODIFIED)
                     {
-                        goto thread_exit;
+                        ++skipped;
+                        continue;
                     }
                 }
-                break;
             }
+            if (kept != i) events[kept] = std::move(event);
+            ++kept;
+        }
+        events.resize(kept);
 
-            case (WAIT_OBJECT_0 + 1): // stopEvent 신호 (종료 요청)
-                WT_LOG("[FileWatcher] Stop event received for: " << project->projectName);
-                goto thread_exit;
+        if (skipped > 0)
+        {
+            WT_LOG("[FileWatcher] Skipped " << skipped << " unchanged-content write(s) in " << project->context->projectName);
+        }
+    }
 
-            default:
-                WT_ERR("[FileWatcher] WaitForMultipleObjects failed for " << project->projectName << " (Error: " << GetLastError() << ")");
-                goto thread_exit;
+    // 처리를 마친 staged 이벤트를 보류분에 합친다. 이후 같은 경로 이벤트는 새 staged 항목으로 따로 처리된다.
+    auto &events = project->readyEvents;
+    std::move(project->stagedEvents.begin(), project->stagedEvents.end(), std::back_inserter(events));
+    project->stagedEvents.clear();
+    project->stagedIndex.clear();
+    if (events.empty()) return;
+
+    // 드레인이 프로젝트 간 시각 순으로 병합하므로 링 안도 시각 순으로 넣는다 (스캔 이벤트는 과거 시각).
+    std::stable_sort(events.begin(), events.end(),
+                     [](const FileChangeEvent &a, const FileChangeEvent &b)
+                     {
+                         return a.timestamp < b.timestamp;
+                     });
+
+    size_t pushed = 0;
+    while (pushed < events.size() && project->eventRing.TryPush(events[pushed]))
+    {
+        ++pushed;
+    }
+    project->queuedEvents.fetch_add(pushed, std::memory_order_relaxed);
+
+    // 링이 가득 차면 남은 것은 메인 스레드가 비울 때까지 이 프로젝트 안에서만 보류한다.
+    events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(pushed));
+    if (!events.empty())
+    {
+        project->heldBackEvents.fetch_add(events.size(), std::memory_order_relaxed);
+        project->readySince = std::chrono::steady_clock::now();
+
+        if (events.size() >= kMaxStagedEvents)
+        {
+            const size_t drop = events.size() - kMaxStagedEvents / 2;
+            events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(drop));
+            project->droppedEvents.fetch_add(drop, std::memory_order_relaxed);
+            WT_ERR("[FileWatcher] Event ring full for " << project->context->projectName << ", dropped " << drop << " oldest event(s)");
         }
     }
 
-thread_exit:
-    WT_LOG("[FileWatcher] Watch thread stopped for: " << project->projectName);
+    if (pushed > 0 && notifyCallback && !notifyScheduled.exchange(true))
+    {
+        notifyCallback();
+    }
 }
 
-void FileWatcher::QueueFileEvent(WatchedProject *project, const std::string &fileName,
-                                 const std::string &fullPath, const DWORD action)
+bool FileWatcher::UpdateStormState(WatchedProject *project, const std::chrono::steady_clock::time_point now)
 {
-    if (project == nullptr) return;
+    const bool active = project->inStorm.load(std::memory_order_relaxed);
+    const auto elapsed = now - project->rateWindowStart;
+    if (elapsed < kStormRateWindow) return active;
 
-    FileChangeEvent event;
-    event.appId = project->appId;
-    event.filePath = fullPath;
-    event.fileName = fileName;
-    event.projectPath = project->projectPath;
-    event.projectName = project->projectName;
-    event.action = action;
-    event.timestamp = std::chrono::system_clock::now();
+    // 마지막 판정 이후 이벤트가 없던 창은 조용한 창으로 센다.
+    const size_t windows = static_cast<size_t>(elapsed / kStormRateWindow);
+    const size_t rate = project->rateWindowEvents;
+    project->rateWindowStart = now;
+    project->rateWindowEvents = 0;
+
+    if (!active)
+    {
+        if (rate < kStormEnterEventsPerWindow) return false;
+
+        project->inStorm.store(true, std::memory_order_relaxed);
+        project->stormEntries.fetch_add(1, std::memory_order_relaxed);
+        project->stormQuietWindows = 0;
+        project->stormNextEmit = now + kStormSampleInterval;
+        WT_LOG("[FileWatcher] Import storm detected in " << project->context->projectName
+               << " (" << rate << " events/s), sampling per folder");
+        return true;
+    }
+
+    project->stormQuietWindows = (rate < kStormExitEventsPerWindow)
+                                     ? project->stormQuietWindows + windows
+                                     : windows - 1;
+    if (project->stormQuietWindows < kStormExitQuietWindows) return true;
+
+    // 해제: 남은 샘플은 지금 staged로 돌려 일반 경로로 내보낸다.
+    project->inStorm.store(false, std::memory_order_relaxed);
+    project->stormExits.fetch_add(1, std::memory_order_relaxed);
+    for (auto &[folder, event] : project->stormSamples)
+    {
+        if (project->stagedIndex.find(event.relativePath) != project->stagedIndex.end()) continue;
+        project->stagedIndex.emplace(event.relativePath, project->stagedEvents.size());
+        project->stagedEvents.emplace_back(std::move(event));
+    }
+    project->stormSamples.clear();
+    WT_LOG("[FileWatcher] Import storm ended in " << project->context->projectName);
+    return false;
+}
 
+void FileWatcher::SampleStagedEvents(WatchedProject *project)
+{
+    for (auto &event : project->stagedEvents)
     {
-        std::lock_guard<std::mutex> lock(pendingEventsMutex);
-        while (pendingEvents.size() >= kMaxPendingEvents)
+        const size_t slash = event.relativePath.rfind('/');
+        std::string folder = (slash == std::string::npos) ? std::string() : event.relativePath.substr(0, slash);
+
+        const auto [it, inserted] = project->stormSamples.try_emplace(std::move(folder));
+        if (inserted)
         {
-            pendingEvents.pop_front();
+            it->second = std::move(event);
+            continue;
+        }
+
+        project->sampledOutEvents.fetch_add(1, std::memory_order_relaxed);
+        if (it->second.timestamp <= event.timestamp)
+        {
+            it->second = std::move(event);
         }
-        pendingEvents.emplace_back(std::move(event));
     }
+    project->stagedEvents.clear();
+    project->stagedIndex.clear();
+}
 
-    if (notifyCallback && !notifyScheduled.exchange(true))
+void FileWatcher::RebuildStagedIndex(WatchedProject *project)
+{
+    project->stagedIndex.clear();
+    for (size_t i = 0; i < project->stagedEvents.size(); ++i)
+    {
+        project->stagedIndex[project->stagedEvents[i].relativePath] = i;
+    }
+}
+
+void FileWatcher::CollectOrphanedEvents(WatchedProject *project)
+{
+    size_t collected = 0;
+    while (FileChangeEvent *event = project->eventRing.Peek())
+    {
+        orphanedEvents.emplace_back(std::move(*event));
+        project->eventRing.Pop();
+        ++collected;
+    }
+
+    // 상한을 넘은 만큼 오래된 것부터 한 번에 버린다.
+    if (orphanedEvents.size() > kMaxOrphanedEvents)
+    {
+        orphanedEvents.erase(orphanedEvents.begin(),
+                             orphanedEvents.end() - static_cast<std::ptrdiff_t>(kMaxOrphanedEvents));
+    }
+
+    if (collected > 0 && notifyCallback && !notifyScheduled.exchange(true))
     {
         notifyCallback();
     }
 }
 
-void FileWatcher::QueueSyntheticProjectScan(WatchedProject *project)
+DWORD FileWatcher::StagedFlushTimeout(const WatchedProject *project) const
+{
+    if (project == nullptr) return INFINITE;
+
+    const bool storm = project->inStorm.load(std::memory_order_relaxed);
+    if (project->stagedEvents.empty() && project->readyEvents.empty() && !storm) return INFINITE;
+
+    const auto now = std::chrono::steady_clock::now();
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    if (!project->stagedEvents.empty())
+    {
+        deadline = project->stagedSince + kCoalesceWindow;
+    }
+    if (!project->readyEvents.empty())
+    {
+        // 링 재시도도 코얼레싱 윈도우 간격으로 한다.
+        deadline = std::min(deadline, project->readySince + kCoalesceWindow);
+    }
+    if (storm)
+    {
+        // 샘플 방출과 해제 판정(조용한 창)은 이벤트가 끊겨도 일어나야 한다.
+        deadline = std::min({deadline, project->stormNextEmit, project->rateWindowStart + kStormRateWindow});
+    }
+    if (now >= deadline) return 0;
+
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+    return static_cast<DWORD>(std::max<std::chrono::milliseconds::rep>(1, remaining.count()));
+}
+
+void FileWatcher::RequestProjectScan(WatchedProject *project, const bool initial, const std::string &scope)
 {
     if (project == nullptr) return;
 
-    struct Candidate
     {
-        std::string fileName;
-        std::string fullPath;
-        fs::file_time_type writeTime;
-    };
+        std::lock_guard<std::mutex> lock(project->scanResultsMutex);
+        auto &scopes = project->scanScopes;
+        if (std::find(scopes.begin(), scopes.end(), scope) == scopes.end()) scopes.push_back(scope);
+    }
+    project->rescanRequested.store(true);
+    if (project->scanRunning.exchange(true))
+    {
+        return; // 실행 중인 스캔이 끝나면 요청을 보고 한 번 더 돈다
+    }
 
-    constexpr size_t kMaxSyntheticEvents = 128;
-    std::vector<Candidate> candidates;
+    // 이전 스캔 스레드는 이미 끝났으므로 즉시 join된다.
+    if (project->scanThread.joinable())
+    {
+        project->scanThread.join();
+    }
 
-    const fs::path root(Utf8ToWide(project->projectPath));
-    std::error_code ec;
-    if (!fs::exists(root, ec)) return;
+    try
+    {
+        project->scanThread = std::thread(&FileWatcher::ScanProjectThread, this, project, initial);
+    }
+    catch (const std::system_error &e)
+    {
+        project->scanRunning.store(false);
+        WT_ERR("[FileWatcher] Failed to start scan thread for " << project->context->projectName << ": " << e.what());
+    }
+}
 
-    fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec);
-    const fs::recursive_directory_iterator end;
+void FileWatcher::ScanProjectThread(WatchedProject *project, const bool initial)
+{
+    // 첫 스캔: 저장된 인덱스가 있으면 그 저장 시각 이후의 변경만 소급 이벤트로 낸다 (없으면 인덱스만 만든다).
+    bool firstPass = initial;
+    bool catchUp = false;
+    uint64_t catchUpSince = 0;
+    if (initial)
+    {
+        std::lock_guard<std::mutex> lock(project->indexMutex);
+        catchUp = project->fileIndex->Load();
+        catchUpSince = project->fileIndex->SavedTime();
+    }
 
-    for (; !ec && it != end; it.increment(ec))
+    while (!project->shouldStop)
     {
-        const fs::directory_entry& entry = *it;
-        const fs::path path = entry.path();
-        const std::string leaf = WideToUtf8(path.filename().wstring());
+        if (!project->rescanRequested.exchange(false))
+        {
+            // 내려놓는 사이에 들어온 요청은 RequestProjectScan이 실행 중으로 보고 지나쳤으므로 여기서 다시 확인한다.
+            project->scanRunning.store(false);
+            if (project->rescanRequested.load() && !project->scanRunning.exchange(true)) continue;
+            return;
+        }
 
-        const bool isDirectory = entry.is_directory(ec);
-        if (ec)
+        // 요청된 범위를 모은다. 전체("")가 있으면 전체만. 앞 회차가 이미 가져간 요청이면 비어 있다.
+        std::vector<std::string> scopes;
         {
-            ec.clear();
-            continue;
+            std::lock_guard<std::mutex> lock(project->scanResultsMutex);
+            scopes.swap(project->scanScopes);
         }
-        if (isDirectory)
+        if (scopes.empty()) continue;
+        if (std::find(scopes.begin(), scopes.end(), std::string()) != scopes.end()) scopes.assign(1, std::string());
+
+        // 첫 스캔의 소급 구간: 저장 시각 이전 수정(크기만 바뀐 파일/복원된 옛 파일 등)은 오프라인 구간이 아니고,
+        // 감시 시작 이후 수정은 실시간 이벤트로 이미 나간다. 구간은 Refresh의 상위 K 선택에 바로 적용한다.
+        const bool catchUpPass = firstPass && catchUp;
+        const uint64_t since = catchUpPass ? catchUpSince : 0;
+        const uint64_t until = catchUpPass ? project->watchStartTime : UINT64_MAX;
+
+        std::vector<FileIndex::Change> changes;
+        size_t changedFiles = 0;
+        size_t indexedFiles = 0;
         {
-            if (ShouldIgnoreFolder(leaf))
-            {
-                it.disable_recursion_pending();
-            }
-            continue;
+            std::lock_guard<std::mutex> lock(project->indexMutex);
+            const size_t maxChanges = !firstPass ? kMaxSyntheticEvents : (catchUp ? kMaxCatchUpEvents : 0);
+            changes = project->fileIndex->Refresh(project->shouldStop, maxChanges, scopes, since, until, &changedFiles);
+            indexedFiles = project->fileIndex->FileCount();
+            // 저장 시각은 종료 때만 옮긴다. 여기서 옮기면 비정상 종료 뒤 소급 구간이 이번 시작부터로 줄어든다.
+            if (firstPass) project->fileIndex->Save(false);
         }
 
-        const bool isRegularFile = entry.is_regular_file(ec);
-        if (ec)
+        if (firstPass)
         {
-            ec.clear();
+            if (catchUp && changedFiles >= kCatchUpBulkMinFiles &&
+                static_cast<double>(changedFiles) >= static_cast<double>(indexedFiles) * kCatchUpBulkFraction)
+            {
+                WT_LOG("[FileWatcher] Catch-up skipped for " << project->context->projectName << ": "
+                       << changedFiles << " of " << indexedFiles << " file(s) changed at once (tool-driven)");
+                changes.clear();
+            }
+
+            if (!changes.empty())
+            {
+                WT_LOG("[FileWatcher] Catch-up: " << changes.size() << " file(s) changed while not watching "
+                       << project->context->projectName);
+            }
+
+            // 결과가 없어도 알린다 (감시 스레드가 실시간 경로 기록을 멈춘다).
+            {
+                std::lock_guard<std::mutex> lock(project->scanResultsMutex);
+                project->catchUpResults = std::move(changes);
+                project->catchUpReady = true;
+            }
+            SetEvent(project->scanEvent);
+            firstPass = false;
             continue;
         }
-        if (!isRegularFile) continue;
 
-        const fs::path relativePath = path.lexically_relative(root);
-        std::string fileName = WideToUtf8(relativePath.generic_wstring());
-        if (fileName.empty()) continue;
-
-        bool shouldIgnore = false;
-        std::istringstream pathStream(fileName);
-        std::string segment;
-        while (std::getline(pathStream, segment, '/'))
+        if (!changes.empty())
         {
-            if (ShouldIgnoreFolder(segment))
             {
-                shouldIgnore = true;
-                break;
+                std::lock_guard<std::mutex> lock(project->scanResultsMutex);
+                std::move(changes.begin(), changes.end(), std::back_inserter(project->scanResults));
             }
+            SetEvent(project->scanEvent);
         }
-        if (shouldIgnore || !IsTrackedFile(fileName, project->extensions)) continue;
+    }
 
-        std::string fullPath = project->projectPath + "/" + fileName;
-        std::replace(fullPath.begin(), fullPath.end(), '\\', '/');
+    project->scanRunning.store(false);
+}
 
-        const auto writeTime = entry.last_write_time(ec);
-        if (ec)
+void FileWatcher::QueueScanResults(WatchedProject *project)
+{
+    std::vector<FileIndex::Change> changes;
+    std::vector<FileIndex::Change> catchUp;
+    bool catchUpReady = false;
+    {
+        std::lock_guard<std::mutex> lock(project->scanResultsMutex);
+        changes.swap(project->scanResults);
+        catchUp.swap(project->catchUpResults);
+        catchUpReady = project->catchUpReady;
+    }
+
+    if (catchUpReady && project->recordingLive)
+    {
+        // 시작 직후 편집한 파일은 실시간 이벤트가 이미 냈다 (같은 편집을 두 번 세지 않는다).
+        for (auto &change : catchUp)
         {
-            ec.clear();
-            continue;
+            if (project->livePaths.find(change.relativePath) == project->livePaths.end())
+            {
+                changes.push_back(std::move(change));
+            }
         }
-
-        candidates.push_back({std::move(fileName), std::move(fullPath), writeTime});
+        project->recordingLive = false;
+        project->livePaths.clear();
     }
 
-    const size_t count = std::min(kMaxSyntheticEvents, candidates.size());
-    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
-                      [](const Candidate& a, const Candidate& b)
-                      {
-                          return a.writeTime > b.writeTime;
-                      });
-
-    for (size_t i = 0; i < count; ++i)
+    // 스캔으로 찾은 변경은 실제 수정 시각으로 기록한다 (미래 시각은 now로 자른다).
+    const auto now = std::chrono::system_clock::now();
+    for (const auto &change : changes)
     {
-        QueueFileEvent(project, candidates[i].fileName, candidates[i].fullPath, FILE_ACTION_MODIFIED);
+        QueueFileEvent(project, change.relativePath, change.action,
+                       std::min(now, FileTimeToTimePoint(change.writeTime)));
     }
 
-    if (count > 0)
+    if (!changes.empty())
     {
-        WT_LOG("[FileWatcher] Queued " << count << " synthetic event(s) for " << project->projectName);
+        WT_LOG("[FileWatcher] Queued " << changes.size() << " synthetic event(s) for " << project->context->projectName);
     }
+
+    // 스캔 동안 미뤄 둔 갱신은 스캔 결과 위에 덮어써야 최신 상태가 된다.
+    SyncFileIndex(project);
 }
 
-void FileWatcher::ProcessFileChanges(char *buffer, DWORD bytesReturned, WatchedProject *project)
+void FileWatcher::SyncFileIndex(WatchedProject *project)
 {
-    auto *info = reinterpret_cast<FILE_NOTIFY_INFORMATION *>(buffer);
+    if (project->deferredIndexUpdates.empty()) return;
 
-    do
+    std::unique_lock<std::mutex> lock(project->indexMutex, std::try_to_lock);
+    if (!lock.owns_lock())
     {
-        std::wstring wFileName(info->FileName, info->FileNameLength / sizeof(WCHAR));
-
-        if (int len = WideCharToMultiByte(CP_UTF8, 0, wFileName.c_str(), -1, nullptr, 0, nullptr, nullptr); len > 0)
+        // 스캔 중: 미뤄 둔다. 너무 많이 쌓이면 버리고 스캔을 한 번 더 돌아 디스크 기준으로 맞춘다.
+        if (project->deferredIndexUpdates.size() > kMaxDeferredIndexUpdates)
         {
-            std::string fileName(len - 1, 0); // null terminator 제외
-            WideCharToMultiByte(CP_UTF8, 0, wFileName.c_str(), -1, &fileName[0], len, nullptr, nullptr);
-
-            std::string fullPath = project->projectPath + "\\" + fileName;
+            project->deferredIndexUpdates.clear();
+            RequestProjectScan(project, false);
+        }
+        return;
+    }
 
-            std::replace(fullPath.begin(), fullPath.end(), '\\', '/');
-            std::replace(fileName.begin(), fileName.end(), '\\', '/');
+    for (const auto &[path, removed] : project->deferredIndexUpdates)
+    {
+        if (removed) project->fileIndex->RemovePath(path);
+        else project->fileIndex->UpdateFile(path);
+    }
+    project->deferredIndexUpdates.clear();
+}
 
-            // 무시할 폴더인지 확인
-            bool shouldIgnore = false;
-            std::istringstream pathStream(fileName);
-            std::string segment;
+void FileWatcher::ProcessFileChanges(const std::vector<WatchInbox::Notification> &notifications, WatchedProject *project)
+{
+    std::string renamedFrom; // 직전 RENAMED_OLD_NAME 경로 (NEW_NAME과 쌍으로 합친다)
 
-            while (std::getline(pathStream, segment, '/'))
+    for (const auto &notification : notifications)
+    {
+        if (notification.rootTag == WatchInbox::kOverflowTag)
+        {
+            // 수신함 적체: 모든 root와 HEAD 구독의 알림이 함께 버려졌다 → 프로젝트 전체 재스캔 + HEAD 다시 읽기.
+            WT_ERR("[FileWatcher] Notification inbox overflowed for " << project->context->projectName << ", rescanning project");
+            RequestProjectScan(project, false);
+            if (const auto &git = project->context->git; git != nullptr && git->IsRepository() && git->Refresh())
             {
-                if (ShouldIgnoreFolder(segment))
-                {
-                    shouldIgnore = true;
-                    break;
-                }
+                WT_LOG("[FileWatcher] " << project->context->projectName << " switched to branch: " << git->Branch());
             }
-
-            if (!shouldIgnore && IsTrackedFile(fileName, project->extensions))
+            renamedFrom.clear();
+            continue;
+        }
+        if (notification.rootTag == kGitHeadTag)
+        {
+            // .git 안의 다른 파일(objects, index 등)은 무시한다. 유실(overflow)이면 HEAD를 다시 읽어 본다.
+            if ((notification.action == 0 || notification.path == "HEAD") &&
+                project->context->git->Refresh())
             {
-                WT_LOG("[FileWatcher] Change: " << fileName << " in " << project->projectName);
-                QueueFileEvent(project, fileName, fullPath, info->Action);
+                WT_LOG("[FileWatcher] " << project->context->projectName << " switched to branch: "
+                       << project->context->git->Branch());
             }
+            continue;
+        }
+        if (notification.rootTag >= project->roots.size()) continue;
+        if (notification.action == 0)
+        {
+            // 레지스트리 버퍼 오버플로/수신함 적체: 개별 이벤트 유실 → 유실이 난 root 아래만 재스캔으로 메운다.
+            // 로컬 패키지는 프로젝트 인덱스 밖이라 메울 것이 없다.
+            const WatchRoot &lost = project->roots[notification.rootTag];
+            renamedFrom.clear();
+            if (lost.external) continue;
+
+            std::string scope = lost.prefix;
+            if (!scope.empty()) scope.pop_back(); // 끝 '/'
+            WT_ERR("[FileWatcher] Change notifications lost for " << project->context->projectName
+                   << ", rescanning " << (scope.empty() ? std::string("project") : scope));
+            RequestProjectScan(project, false, scope);
+            continue;
         }
 
-        if (info->NextEntryOffset == 0)
+        // root 기준 경로 앞에 root.prefix("Assets/" 또는 외부 패키지 절대 경로)를 붙인다.
+        const WatchRoot &root = project->roots[notification.rootTag];
+        const std::string fileName = root.prefix + notification.path;
+        const DWORD action = notification.action;
+
+        // rename은 OLD_NAME → NEW_NAME 연속 레코드로 온다. old 경로는 더 이상 존재하지 않으므로
+        // 쌍이 맞으면 old 이벤트를 버리고 new 이벤트 1건만 남긴다.
+        if (action == FILE_ACTION_RENAMED_NEW_NAME && !renamedFrom.empty())
         {
-            break;
+            DropStagedEvent(project, renamedFrom);
+        }
+        renamedFrom = (action == FILE_ACTION_RENAMED_OLD_NAME) ? fileName : std::string();
+
+        // 디렉토리 삭제/이동은 추적 확장자가 없으므로 여기서 바로 인덱스 하위 항목 정리를 예약한다.
+        if (!root.external && (action == FILE_ACTION_REMOVED || action == FILE_ACTION_RENAMED_OLD_NAME))
+        {
+            project->deferredIndexUpdates.emplace_back(fileName, true);
         }
 
-        info = reinterpret_cast<FILE_NOTIFY_INFORMATION *>(reinterpret_cast<char *>(info) + info->NextEntryOffset);
-    } while (true);
+        // 에디터 버전 파일은 추적 대상이 아니지만, 바뀌면(에디터 업그레이드) 캐시된 메타데이터를 버린다.
+        if (!root.external && !project->metadataFile.empty() && fileName == project->metadataFile && metadataCallback)
+        {
+            metadataCallback(project->context->projectPath);
+        }
+
+        // 확장자 검사가 더 싸므로 먼저, 무시 규칙(DFA)은 추적 대상에만 적용.
+        // 외부 패키지는 패키지 폴더 기준 경로에 기본 규칙(obj/, bin/ 등)만 적용한다.
+        // 프로젝트 .gitignore의 앵커 규칙(/Library/ 등)은 프로젝트 루트 기준이라 패키지 안 폴더와 맞지 않는다.
+        const IgnoreRules &rules = root.external ? *project->packageIgnoreRules : *project->ignoreRules;
+        if (IsTrackedFile(fileName, project->extensions) &&
+            !rules.IsIgnored(root.external ? notification.path : fileName, false))
+        {
+            ++project->rateWindowEvents;
+            WT_LOG("[FileWatcher] Change: " << fileName << " in " << project->context->projectName);
+            if (project->recordingLive && project->livePaths.size() < kMaxLivePaths)
+            {
+                project->livePaths.insert(fileName);
+            }
+            QueueFileEvent(project, fileName, action, std::chrono::system_clock::now());
+        }
+    }
+
+    SyncFileIndex(project);
 }
 
 bool FileWatcher::IsTrackedFile(const std::string &fileName, const std::unordered_set<std::string> &extensions) const
@@ -430,15 +1051,6 @@ bool FileWatcher::IsTrackedFile(const std::string &fileName, const std::unordere
     return extensions.find(extension) != extensions.end();
 }
 
-bool FileWatcher::ShouldIgnoreFolder(const std::string &folderName) const
-{
-    std::string lower = folderName;
-    std::transform(lower.begin(), lower.end(), lower.begin(),
-                   [](const unsigned char c) { return static_cast<char>(::tolower(c)); });
-
-    return Config::GetIgnoreFolders().count(lower) > 0;
-}
-
 void FileWatcher::StopWatching(const std::string &projectPath)
 {
     std::unique_ptr<WatchedProject> projectToStop;
@@ -449,7 +1061,7 @@ void FileWatcher::StopWatching(const std::string &projectPath)
         const auto it = std::find_if(watchedProjects.begin(), watchedProjects.end(),
                                      [&projectPath](const std::unique_ptr<WatchedProject> &project)
                                      {
-                                         return project->projectPath == projectPath;
+                                         return project->context->projectPath == projectPath;
                                      });
 
         if (it == watchedProjects.end())
@@ -461,21 +1073,18 @@ void FileWatcher::StopWatching(const std::string &projectPath)
         watchedProjects.erase(it);
     }
 
-    WT_LOG("[FileWatcher] Stopping watch for: " << projectToStop->projectName);
+    WT_LOG("[FileWatcher] Stopping watch for: " << projectToStop->context->projectName);
     projectToStop->shouldStop = true;
 
     if (projectToStop->stopEvent != nullptr)
     {
         SetEvent(projectToStop->stopEvent);
     }
-    if (projectToStop->directoryHandle != nullptr && projectToStop->directoryHandle != INVALID_HANDLE_VALUE)
-    {
-        CancelIoEx(projectToStop->directoryHandle, nullptr);
-    }
     if (projectToStop->watchThread.joinable())
     {
         projectToStop->watchThread.join();
     }
+    CollectOrphanedEvents(projectToStop.get());
 }
 
 void FileWatcher::StopWatchingByApp(const std::string &appId)
@@ -487,7 +1096,7 @@ void FileWatcher::StopWatchingByApp(const std::string &appId)
         auto it = watchedProjects.begin();
         while (it != watchedProjects.end())
         {
-            if ((*it)->appId == appId)
+            if ((*it)->context->appId == appId)
             {
                 projectsToStop.push_back(std::move(*it));
                 it = watchedProjects.erase(it);
@@ -500,14 +1109,11 @@ void FileWatcher::StopWatchingByApp(const std::string &appId)
     {
         project->shouldStop = true;
         if (project->stopEvent != nullptr) SetEvent(project->stopEvent);
-        if (project->directoryHandle != nullptr && project->directoryHandle != INVALID_HANDLE_VALUE)
-        {
-            CancelIoEx(project->directoryHandle, nullptr);
-        }
     }
     for (auto &project: projectsToStop)
     {
         if (project->watchThread.joinable()) project->watchThread.join();
+        CollectOrphanedEvents(project.get());
     }
 }
 
@@ -529,10 +1135,6 @@ void FileWatcher::StopAllWatching()
         {
             SetEvent(project->stopEvent);
         }
-        if (project->directoryHandle != nullptr && project->directoryHandle != INVALID_HANDLE_VALUE)
-        {
-            CancelIoEx(project->directoryHandle, nullptr);
-        }
     }
 
     for (auto &project: projectsToStop)
@@ -541,44 +1143,65 @@ void FileWatcher::StopAllWatching()
         {
             project->watchThread.join();
         }
+        CollectOrphanedEvents(project.get());
     }
 
     WT_LOG("[FileWatcher] All watches stopped");
 }
 
-void FileWatcher::DrainPendingEvents(const size_t maxEvents)
+void FileWatcher::DrainPendingEvents(const std::chrono::microseconds budget)
 {
-    if (maxEvents == 0)
-    {
-        return;
-    }
-
     // 드레인 시작 전에 예약 플래그를 내려, 이 시점 이후 도착하는 이벤트는 새 통지를 post하도록 한다.
     notifyScheduled.store(false);
 
     if (!changeCallback) return;
 
-    bool moreRemaining = false;
-    std::vector<FileChangeEvent> localEvents;
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    do
     {
-        std::lock_guard<std::mutex> lock(pendingEventsMutex);
-        const size_t count = std::min(maxEvents, pendingEvents.size());
-        localEvents.reserve(count);
-        for (size_t i = 0; i < count; ++i)
+        drainBatch.clear();
+
+        // 중지된 프로젝트의 잔여 이벤트가 먼저 (링의 어떤 이벤트보다 먼저 적재되었다)
+        const size_t orphanCount = std::min(kMaxDrainBatch, orphanedEvents.size());
+        std::move(orphanedEvents.begin(), orphanedEvents.begin() + static_cast<std::ptrdiff_t>(orphanCount),
+                  std::back_inserter(drainBatch));
+        orphanedEvents.erase(orphanedEvents.begin(), orphanedEvents.begin() + static_cast<std::ptrdiff_t>(orphanCount));
+
+        // watchedProjects는 이 스레드에서만 바뀌므로 락 없이 순회한다. 링 head끼리 비교하는 k-way 병합.
+        while (drainBatch.size() < kMaxDrainBatch)
         {
-            localEvents.emplace_back(std::move(pendingEvents.front()));
-            pendingEvents.pop_front();
+            WatchedProject *source = nullptr;
+            FileChangeEvent *oldest = nullptr;
+            for (const auto &project : watchedProjects)
+            {
+                FileChangeEvent *head = project->eventRing.Peek();
+                if (head != nullptr && (oldest == nullptr || head->timestamp < oldest->timestamp))
+                {
+                    source = project.get();
+                    oldest = head;
+                }
+            }
+            if (source == nullptr) break;
+
+            drainBatch.emplace_back(std::move(*oldest));
+            source->eventRing.Pop();
         }
 
-        if (!pendingEvents.empty()) moreRemaining = true;
-    }
+        if (drainBatch.empty()) break;
+        changeCallback(drainBatch.data(), drainBatch.size());
+    } while (std::chrono::steady_clock::now() < deadline);
+
+    // 배치 문자열 메모리는 여기서 반환하고 용량만 유지한다.
+    drainBatch.clear();
 
-    for (const auto &event: localEvents)
+    bool moreRemaining = !orphanedEvents.empty();
+    for (const auto &project : watchedProjects)
     {
-        changeCallback(event);
+        if (moreRemaining) break;
+        moreRemaining = project->eventRing.Peek() != nullptr;
     }
 
-    // maxEvents 한도로 다 비우지 못했으면 다음 처리를 위해 통지를 다시 예약
+    // 예산 안에 다 비우지 못했으면 다음 처리를 위해 통지를 다시 예약
     if (moreRemaining && notifyCallback && !notifyScheduled.exchange(true))
     {
         notifyCallback();
@@ -601,10 +1224,25 @@ std::vector<WatchedProjectInfo> FileWatcher::GetWatchedProjects() const
     for (const auto &project: watchedProjects)
     {
         WatchedProjectInfo info;
-        info.appId = project->appId;
-        info.projectPath = project->projectPath;
-        info.projectName = project->projectName;
-        info.editorVersion = project->editorVersion;
+        info.appId = project->context->appId;
+        info.projectPath = project->context->projectPath;
+        info.projectName = project->context->projectName;
+        info.editorVersion = project->context->editorVersion;
+        info.pendingEvents = project->eventRing.SizeApprox();
+        info.queuedEvents = project->queuedEvents.load(std::memory_order_relaxed);
+        info.heldBackEvents = project->heldBackEvents.load(std::memory_order_relaxed);
+        info.droppedEvents = project->droppedEvents.load(std::memory_order_relaxed);
+        info.inStorm = project->inStorm.load(std::memory_order_relaxed);
+        info.stormEntries = project->stormEntries.load(std::memory_order_relaxed);
+        info.stormExits = project->stormExits.load(std::memory_order_relaxed);
+        info.sampledOutEvents = project->sampledOutEvents.load(std::memory_order_relaxed);
+        for (const auto &root : project->roots)
+        {
+            const WatchRegistry::WatchStats stats = watchRegistry.GetStats(root.subscription);
+            info.notifyBufferBytes += stats.bufferSize;
+            info.notifyOverflows += stats.overflows;
+            info.notifyResizes += stats.resizes;
+        }
         projects.emplace_back(std::move(info));
     }
 
@@ -18,6 +18,15 @@ namespace
         return out;
     }
 
+    // 시스템 입력(키보드/마우스)이 window 안에 있었는지. 알 수 없으면 있었다고 본다 (keep-alive를 막지 않도록).
+    bool HasInputWithin(const std::chrono::milliseconds window)
+    {
+        LASTINPUTINFO info{};
+        info.cbSize = sizeof(info);
+        if (!GetLastInputInfo(&info)) return true;
+        return GetTickCount() - info.dwTime < static_cast<DWORD>(window.count());
+    }
+
     std::string GetWindowTitleUtf8(const HWND hwnd)
     {
         const int len = GetWindowTextLengthW(hwnd);
@@ -173,11 +182,65 @@ void FocusDetector::ClearFocus()
     lastEntity.clear();
     lastProject.clear();
     lastEditorVersion.clear();
+    lastRendering = false;
+}
+
+void FocusDetector::ClearRenderTarget()
+{
+    if (!hasRenderTarget) return;
+    if (renderTarget.processId != lastProcessId) activity.Forget(renderTarget.processId);
+    hasRenderTarget = false;
+    renderTarget = RenderTarget{};
+}
+
+void FocusDetector::KeepRenderTarget()
+{
+    if (!hasFocusTarget || !lastRendering || lastProcessId == 0) return;
+
+    ClearRenderTarget();
+    renderTarget = RenderTarget{lastProcessId, lastAppId, lastEntity, lastProject, lastEditorVersion};
+    hasRenderTarget = true;
+    WT_LOG("[FocusDetector] " << lastAppId << " (PID " << lastProcessId << ") is rendering, keeping it alive after focus loss");
+}
+
+void FocusDetector::SendRenderKeepAlive()
+{
+    if (!hasRenderTarget) return;
+
+    // 다시 포커스됐으면 일반 keep-alive가 맡는다.
+    if (hasFocusTarget && renderTarget.processId == lastProcessId)
+    {
+        hasRenderTarget = false;
+        renderTarget = RenderTarget{};
+        return;
+    }
+
+    if (!AppRegistry::IsEnabled(renderTarget.appId) || g_processMonitor == nullptr ||
+        !g_processMonitor->IsProcessRunning(renderTarget.processId))
+    {
+        ClearRenderTarget();
+        return;
+    }
+
+    if (const ProcessActivity sample = activity.Sample(renderTarget.processId); sample.known && !sample.rendering)
+    {
+        WT_LOG("[FocusDetector] " << renderTarget.appId << " render finished");
+        ClearRenderTarget();
+        return;
+    }
+
+    if (heartbeatCallback)
+    {
+        heartbeatCallback(renderTarget.appId, renderTarget.entity, renderTarget.project, renderTarget.editorVersion);
+    }
 }
 
 void FocusDetector::EmitHeartbeat(const std::string& appId, const std::string& entity,
                                   const std::string& project, const std::string& editorVersion)
 {
+    // 새 포커스 대상: 활동 구간을 지금부터 잰다.
+    if (focusedProcessId != lastProcessId && focusedProcessId != 0) activity.Reset(focusedProcessId);
+
     lastProcessId = focusedProcessId;
     lastAppId = appId;
     lastEntity = entity;
@@ -213,8 +276,9 @@ void FocusDetector::EmitForWindow(const HWND hwnd)
         return;
     }
 
-    // WindowTitle: 제목 파싱 + 커맨드라인 entity로 fallback (plan 4단계 우선순위)
+    // WindowTitle: 제목 파싱 + 열린 파일/커맨드라인 entity로 fallback (plan 4단계 우선순위)
     const std::string titleFile = ParseTitleFile(def->displayName, GetWindowTitleUtf8(hwnd));
+    g_processMonitor->RefreshOpenFile(inst->processId, LeafName(titleFile)); // 보조 프로세스 창이면 루트 인스턴스 기준
     const std::string& cmdEntity = inst->entity;
 
     std::string entity;
@@ -254,7 +318,8 @@ void FocusDetector::EmitForWindow(const HWND hwnd)
 
 void FocusDetector::OnForegroundChanged(const HWND hwnd)
 {
-    // 포커스 전이 시 추적 상태 초기화.
+    // 포커스 전이 시 추적 상태 초기화 (렌더 중이던 대상은 렌더 keep-alive로 넘긴다).
+    KeepRenderTarget();
     ClearFocus();
 
     if (hwnd == nullptr || g_processMonitor == nullptr) return;
@@ -292,6 +357,8 @@ void FocusDetector::OnTitleChanged(const HWND hwnd)
 
 void FocusDetector::SendPeriodicHeartbeat()
 {
+    SendRenderKeepAlive();
+
     if (!hasFocusTarget) return;
 
     if (lastAppId.empty() || !AppRegistry::IsEnabled(lastAppId))
@@ -307,6 +374,16 @@ void FocusDetector::SendPeriodicHeartbeat()
         return;
     }
 
+    // 자리를 비웠는지: 구간에 입력도 없고 프로세스도 유휴면 keep-alive를 보내지 않는다 (렌더는 CPU로 활성).
+    const ProcessActivity sample = lastProcessId != 0 ? activity.Sample(lastProcessId) : ProcessActivity{};
+    lastRendering = sample.known && sample.rendering;
+    if (sample.known && !sample.active &&
+        !HasInputWithin(std::chrono::duration_cast<std::chrono::milliseconds>(heartbeatInterval)))
+    {
+        WT_LOG("[FocusDetector] " << lastAppId << " idle (CPU " << sample.cpuCores << " cores), keep-alive skipped");
+        return;
+    }
+
     const auto now = std::chrono::steady_clock::now();
     if (now - lastHeartbeat >= heartbeatInterval)
     {
@@ -323,6 +400,7 @@ void FocusDetector::ClearFocusForApp(const std::string& appId)
     {
         ClearFocus();
     }
+    if (hasRenderTarget && renderTarget.appId == appId) ClearRenderTarget();
 }
 
 void FocusDetector::ClearFocusForProcess(const DWORD pid)
@@ -330,6 +408,8 @@ void FocusDetector::ClearFocusForProcess(const DWORD pid)
     if (pid == 0) return;
     if (focusedProcessId == pid || lastProcessId == pid)
     {
+        activity.Forget(pid);
         ClearFocus();
     }
+    if (hasRenderTarget && renderTarget.processId == pid) ClearRenderTarget();
 }
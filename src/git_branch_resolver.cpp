@@ -0,0 +1,117 @@
+#include "git_branch_resolver.h"
+
+#include <cstring>
+
+namespace
+{
+    std::wstring Utf8ToWide(const std::string& s)
+    {
+        if (s.empty()) return L"";
+        const int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (len <= 1) return L"";
+        std::wstring w(static_cast<size_t>(len), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), len);
+        w.resize(static_cast<size_t>(len - 1));
+        return w;
+    }
+
+    std::string ReadSmallFile(const fs::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return "";
+
+        std::string content;
+        std::getline(file, content);
+        while (!content.empty() && std::isspace(static_cast<unsigned char>(content.back())))
+        {
+            content.pop_back();
+        }
+        return content;
+    }
+}
+
+GitBranchResolver::GitBranchResolver(const std::string &projectPath)
+{
+    // 프로젝트가 저장소 하위 폴더일 수 있으므로 드라이브 루트까지 올라간다.
+    std::error_code ec;
+    fs::path dir = fs::absolute(fs::path(Utf8ToWide(projectPath)), ec);
+    while (!ec && !dir.empty())
+    {
+        headDirectory = ResolveGitDirectory(dir);
+        if (!headDirectory.empty()) break;
+
+        fs::path parent = dir.parent_path();
+        if (parent == dir) break;
+        dir = std::move(parent);
+    }
+
+    if (headDirectory.empty()) return;
+
+    Refresh();
+    const std::string current = Branch();
+    WT_LOG("[GitBranchResolver] " << projectPath << ": " << (current.empty() ? "(detached)" : current));
+}
+
+std::string GitBranchResolver::Branch() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return branch;
+}
+
+bool GitBranchResolver::Refresh()
+{
+    if (headDirectory.empty()) return false;
+
+    // git은 HEAD를 HEAD.lock에 쓰고 이름을 바꾼다. 바뀌는 도중이면 다음 알림에서 다시 읽는다.
+    const std::string content = ReadSmallFile(headDirectory / L"HEAD");
+    if (content.empty()) return false;
+
+    std::string parsed = ParseHead(content);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (parsed == branch) return false;
+    branch = std::move(parsed);
+    return true;
+}
+
+fs::path GitBranchResolver::ResolveGitDirectory(const fs::path &dir)
+{
+    const fs::path dotGit = dir / L".git";
+    std::error_code ec;
+
+    if (fs::is_directory(dotGit, ec))
+    {
+        return fs::is_regular_file(dotGit / L"HEAD", ec) ? dotGit : fs::path();
+    }
+    if (!fs::is_regular_file(dotGit, ec)) return fs::path();
+
+    // worktree/submodule: ".git" 파일에 "gitdir: <경로>" 한 줄 (상대 경로면 .git 파일 위치 기준)
+    const std::string content = ReadSmallFile(dotGit);
+    constexpr const char *kPrefix = "gitdir:";
+    if (content.compare(0, std::strlen(kPrefix), kPrefix) != 0) return fs::path();
+
+    size_t start = std::strlen(kPrefix);
+    while (start < content.size() && std::isspace(static_cast<unsigned char>(content[start]))) ++start;
+
+    fs::path target(Utf8ToWide(content.substr(start)));
+    if (target.empty()) return fs::path();
+    if (target.is_relative()) target = dir / target;
+    target = target.lexically_normal();
+
+    return fs::is_regular_file(target / L"HEAD", ec) ? target : fs::path();
+}
+
+std::string GitBranchResolver::ParseHead(const std::string &content)
+{
+    constexpr const char *kRefPrefix = "ref:";
+    constexpr const char *kHeadsPrefix = "refs/heads/";
+
+    if (content.compare(0, std::strlen(kRefPrefix), kRefPrefix) != 0) return ""; // detached (커밋 해시)
+
+    size_t start = std::strlen(kRefPrefix);
+    while (start < content.size() && std::isspace(static_cast<unsigned char>(content[start]))) ++start;
+
+    const std::string ref = content.substr(start);
+    if (ref.compare(0, std::strlen(kHeadsPrefix), kHeadsPrefix) == 0) return ref.substr(std::strlen(kHeadsPrefix));
+    return ref;
+}
@@ -0,0 +1,597 @@
+#include "ignore_rules.h"
+
+#include <map>
+
+namespace
+{
+    // DFA 상태 상한. 넘으면 새 전이는 NFA 시뮬레이션으로 처리한다 (메모리 폭주 방지).
+    constexpr size_t kMaxDfaStates = 8192;
+    constexpr size_t kMaxRules = 0xFFFF;
+    constexpr size_t kMaxTokensPerRule = 0x7FFF;
+
+    constexpr const wchar_t *kIgnoreFileNames[] = {L".gitignore", L".wakatimeignore"};
+
+    unsigned char FoldCase(const unsigned char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+    }
+
+    std::wstring Utf8ToWide(const std::string& s)
+    {
+        if (s.empty()) return L"";
+        const int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (len <= 1) return L"";
+        std::wstring w(static_cast<size_t>(len), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), len);
+        w.resize(static_cast<size_t>(len - 1));
+        return w;
+    }
+}
+
+std::shared_ptr<const IgnoreRules> IgnoreRules::LoadForProject(const std::string &projectPath)
+{
+    auto rules = std::make_shared<IgnoreRules>();
+
+    // 기본 폴더 규칙이 가장 낮은 우선순위. 프로젝트 파일에서 `!Build/` 로 되살릴 수 있다.
+    for (const auto &folder : Config::IGNORE_FOLDERS)
+    {
+        rules->AddPattern(folder + "/");
+    }
+
+    const fs::path root(Utf8ToWide(projectPath));
+    for (const wchar_t *name : kIgnoreFileNames)
+    {
+        rules->AddPatternsFromFile(root / name);
+    }
+
+    rules->Compile();
+    WT_LOG("[IgnoreRules] Compiled " << rules->RuleCount() << " rule(s) for " << projectPath);
+    return rules;
+}
+
+std::shared_ptr<const IgnoreRules> IgnoreRules::Defaults()
+{
+    static const std::shared_ptr<const IgnoreRules> defaults = []()
+    {
+        auto rules = std::make_shared<IgnoreRules>();
+        for (const auto &folder : Config::IGNORE_FOLDERS)
+        {
+            rules->AddPattern(folder + "/");
+        }
+        rules->Compile();
+#ifndef NDEBUG
+        SelfCheck();
+#endif
+        return std::shared_ptr<const IgnoreRules>(std::move(rules));
+    }();
+    return defaults;
+}
+
+bool IgnoreRules::AddPatternsFromFile(const fs::path &filePath)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        AddPattern(line);
+    }
+    return true;
+}
+
+void IgnoreRules::AddPattern(const std::string &line)
+{
+    if (compiled || rules.size() >= kMaxRules) return;
+
+    std::string pattern = line;
+    if (!pattern.empty() && pattern.back() == '\r') pattern.pop_back();
+
+    // 이스케이프되지 않은 끝 공백 제거
+    while (!pattern.empty() && (pattern.back() == ' ' || pattern.back() == '\t'))
+    {
+        if (pattern.size() >= 2 && pattern[pattern.size() - 2] == '\\') break;
+        pattern.pop_back();
+    }
+    if (pattern.empty() || pattern[0] == '#') return;
+
+    if (Rule rule; ParseRule(pattern, rule))
+    {
+        rules.push_back(std::move(rule));
+    }
+}
+
+bool IgnoreRules::ParseRule(const std::string &patternIn, Rule &rule)
+{
+    std::string pattern = patternIn;
+
+    if (pattern[0] == '!')
+    {
+        rule.negate = true;
+        pattern.erase(0, 1);
+    }
+    else if (pattern.size() >= 2 && pattern[0] == '\\' && (pattern[1] == '!' || pattern[1] == '#'))
+    {
+        pattern.erase(0, 1);
+    }
+
+    if (!pattern.empty() && pattern.back() == '/')
+    {
+        rule.dirOnly = true;
+        while (!pattern.empty() && pattern.back() == '/') pattern.pop_back();
+    }
+    if (pattern.empty()) return false;
+
+    // 중간/앞에 '/'가 있으면 루트 기준 앵커, 없으면 모든 깊이에서 매치 (`**/` 접두와 동일)
+    const bool anchored = pattern.find('/') != std::string::npos;
+    while (!pattern.empty() && pattern.front() == '/') pattern.erase(0, 1);
+    if (pattern.empty()) return false;
+
+    if (!anchored)
+    {
+        rule.tokens.push_back({Token::DirStar, 0, 0});
+    }
+
+    const size_t n = pattern.size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        const char c = pattern[i];
+        const bool segmentStart = (i == 0 || pattern[i - 1] == '/');
+
+        if (c == '*' && i + 1 < n && pattern[i + 1] == '*' && segmentStart &&
+            (i + 2 == n || pattern[i + 2] == '/'))
+        {
+            if (i + 2 == n)
+            {
+                // 끝의 `**` : 하위 전부. 패턴 전체가 `**` 이면 모든 경로.
+                rule.tokens.push_back({Token::AnyRun, 0, 0});
+                i += 1;
+            }
+            else
+            {
+                // `**/` : 0개 이상의 디렉토리
+                rule.tokens.push_back({Token::DirStar, 0, 0});
+                i += 2;
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+            case '*':
+                if (rule.tokens.empty() || rule.tokens.back().kind != Token::Star)
+                {
+                    rule.tokens.push_back({Token::Star, 0, 0});
+                }
+                break;
+
+            case '?':
+                rule.tokens.push_back({Token::AnyChar, 0, 0});
+                break;
+
+            case '[':
+            {
+                const size_t close = pattern.find(']', i + 2);
+                if (close == std::string::npos)
+                {
+                    rule.tokens.push_back({Token::Literal, '[', 0});
+                    break;
+                }
+
+                std::array<bool, 256> members{};
+                size_t j = i + 1;
+                bool negated = false;
+                if (pattern[j] == '!' || pattern[j] == '^')
+                {
+                    negated = true;
+                    ++j;
+                }
+                for (; j < close; ++j)
+                {
+                    const auto lo = FoldCase(static_cast<unsigned char>(pattern[j]));
+                    if (j + 2 < close && pattern[j + 1] == '-')
+                    {
+                        const auto hi = FoldCase(static_cast<unsigned char>(pattern[j + 2]));
+                        for (unsigned v = lo; v <= hi; ++v) members[v] = true;
+                        j += 2;
+                    }
+                    else
+                    {
+                        members[lo] = true;
+                    }
+                }
+                if (negated)
+                {
+                    for (auto &member : members) member = !member;
+                }
+                members['/'] = false;
+
+                rule.tokens.push_back({Token::Class, 0, static_cast<uint16_t>(charClasses.size())});
+                charClasses.push_back(members);
+                i = close;
+                break;
+            }
+
+            case '\\':
+                if (i + 1 < n)
+                {
+                    ++i;
+                }
+                rule.tokens.push_back({Token::Literal, FoldCase(static_cast<unsigned char>(pattern[i])), 0});
+                break;
+
+            default:
+                rule.tokens.push_back({Token::Literal, FoldCase(static_cast<unsigned char>(c)), 0});
+                break;
+        }
+    }
+
+    return !rule.tokens.empty() && rule.tokens.size() <= kMaxTokensPerRule;
+}
+
+void IgnoreRules::Closure(std::vector<Item> &items) const
+{
+    // ε-전이: Star/DirStar(세그먼트 경계)/AnyRun(1글자 이상 소비 후)는 다음 토큰으로 넘어갈 수 있다.
+    // 전이는 항상 pos+1 방향이라 중복 검사 없이 끝까지 펼친 뒤 한 번에 정렬/중복 제거한다.
+    for (size_t k = 0; k < items.size(); ++k)
+    {
+        const Item item = items[k];
+        const uint32_t ruleIndex = item >> 16;
+        const uint32_t pos = (item >> 1) & 0x7FFF;
+        const uint32_t sub = item & 1;
+        const auto &tokens = rules[ruleIndex].tokens;
+        if (pos >= tokens.size()) continue;
+
+        const Token::Kind kind = tokens[pos].kind;
+        const bool skippable =
+            kind == Token::Star ||
+            (kind == Token::DirStar && sub == 0) ||
+            (kind == Token::AnyRun && sub == 1);
+        if (skippable)
+        {
+            items.push_back((ruleIndex << 16) | ((pos + 1) << 1));
+        }
+    }
+
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+}
+
+bool IgnoreRules::IsUnanchored(const uint32_t ruleIndex) const
+{
+    return rules[ruleIndex].tokens.front().kind == Token::DirStar;
+}
+
+void IgnoreRules::Advance(const std::vector<Item> &items, const unsigned char byte, std::vector<Item> &out) const
+{
+    for (const Item item : items)
+    {
+        if (item >= kAwaitSegment) continue; // 표식
+
+        const uint32_t ruleIndex = item >> 16;
+        const uint32_t pos = (item >> 1) & 0x7FFF;
+        const auto &tokens = rules[ruleIndex].tokens;
+        if (pos >= tokens.size()) continue;
+
+        const Token &token = tokens[pos];
+        const Item advance = (ruleIndex << 16) | ((pos + 1) << 1);
+        const Item stay = (ruleIndex << 16) | (pos << 1);
+
+        switch (token.kind)
+        {
+            case Token::Literal:
+                if (byte == token.ch) out.push_back(advance);
+                break;
+            case Token::AnyChar:
+                if (byte != '/') out.push_back(advance);
+                break;
+            case Token::Class:
+                if (byte != '/' && charClasses[token.classId][byte]) out.push_back(advance);
+                break;
+            case Token::Star:
+                if (byte != '/') out.push_back(stay);
+                break;
+            case Token::DirStar:
+                // '/'를 만나야 세그먼트 경계(sub=0)로 돌아와 다음 토큰으로 넘어갈 수 있다.
+                out.push_back(byte == '/' ? stay : (stay | 1));
+                break;
+            case Token::AnyRun:
+                out.push_back(stay | 1);
+                break;
+        }
+    }
+}
+
+std::vector<IgnoreRules::Item> IgnoreRules::Step(const std::vector<Item> &items, const unsigned char byte) const
+{
+    std::vector<Item> next;
+    next.reserve(items.size() + 4);
+    Advance(items, byte, next);
+
+    // 세그먼트 시작이면 "모든 깊이" 규칙들이 이 바이트로 새로 시작한 위치를 합친다.
+    if (!items.empty() && items.back() == kSegmentStart)
+    {
+        const auto &injected = segmentStartSteps[byteClass[byte]];
+        next.insert(next.end(), injected.begin(), injected.end());
+    }
+
+    Closure(next);
+    if (hasUnanchored)
+    {
+        // 세그먼트 안에서 이어지는 규칙이 없어도 다음 '/' 뒤에서 "모든 깊이" 규칙이 다시 시작되므로
+        // 빈 집합(dead)으로 만들지 않는다. 두 표식 모두 최댓값 쪽이라 정렬 상태가 유지된다.
+        next.push_back(byte == '/' ? kSegmentStart : kAwaitSegment);
+    }
+    return next;
+}
+
+IgnoreRules::StateInfo IgnoreRules::Accepting(const std::vector<Item> &items) const
+{
+    StateInfo info;
+    for (const Item item : items)
+    {
+        if (item == kSegmentStart)
+        {
+            info.matchAny = std::max(info.matchAny, segmentStartAccept.matchAny);
+            info.matchFile = std::max(info.matchFile, segmentStartAccept.matchFile);
+            continue;
+        }
+        if (item == kAwaitSegment) continue;
+
+        const auto ruleIndex = static_cast<int32_t>(item >> 16);
+        const uint32_t pos = (item >> 1) & 0x7FFF;
+        const Rule &rule = rules[static_cast<size_t>(ruleIndex)];
+        if (pos != rule.tokens.size()) continue;
+
+        info.matchAny = std::max(info.matchAny, ruleIndex);
+        if (!rule.dirOnly) info.matchFile = std::max(info.matchFile, ruleIndex);
+    }
+    return info;
+}
+
+void IgnoreRules::Compile()
+{
+    if (compiled) return;
+    compiled = true;
+
+    // 1) 입력 바이트를 동치 클래스로 압축: 규칙들이 구분하는 바이트만 별도 클래스가 된다.
+    std::array<bool, 256> literal{};
+    for (const auto &rule : rules)
+    {
+        for (const auto &token : rule.tokens)
+        {
+            if (token.kind == Token::Literal) literal[token.ch] = true;
+        }
+    }
+
+    std::map<std::string, uint8_t> classBySignature;
+    for (unsigned b = 0; b < 256; ++b)
+    {
+        const auto folded = FoldCase(static_cast<unsigned char>(b));
+        if (folded != b) continue; // 대문자는 아래에서 소문자 클래스를 공유
+
+        std::string signature;
+        signature.push_back(b == '/' ? '/' : '.');
+        signature.push_back(literal[b] ? static_cast<char>(b) : '\0');
+        for (const auto &members : charClasses)
+        {
+            signature.push_back(members[b] ? '1' : '0');
+        }
+
+        const auto [it, inserted] = classBySignature.emplace(signature, static_cast<uint8_t>(classSample.size()));
+        if (inserted) classSample.push_back(static_cast<unsigned char>(b));
+        byteClass[b] = it->second;
+    }
+    for (unsigned b = 'A'; b <= 'Z'; ++b)
+    {
+        byteClass[b] = byteClass[FoldCase(static_cast<unsigned char>(b))];
+    }
+    const size_t classCount = classSample.size();
+
+    // 2) "모든 깊이" 규칙(선두 DirStar)은 모든 상태에 살아 있으므로 상태 집합에 넣지 않고
+    //    kSegmentStart 표식 하나로 대신한다. 세그먼트 시작에서 각 클래스로 진입하는 위치는 미리 계산.
+    std::vector<Item> start;
+    std::vector<Item> segmentStartItems;
+    for (uint32_t r = 0; r < rules.size(); ++r)
+    {
+        if (IsUnanchored(r))
+        {
+            hasUnanchored = true;
+            segmentStartItems.push_back(r << 16);
+        }
+        else
+        {
+            start.push_back(r << 16);
+        }
+    }
+    Closure(segmentStartItems);
+    segmentStartItems.erase(std::remove_if(segmentStartItems.begin(), segmentStartItems.end(),
+                                           [](const Item item) { return ((item >> 1) & 0x7FFF) == 0; }),
+                            segmentStartItems.end());
+    segmentStartAccept = Accepting(segmentStartItems);
+
+    segmentStartSteps.resize(classCount);
+    for (size_t c = 0; c < classCount; ++c)
+    {
+        Advance(segmentStartItems, classSample[c], segmentStartSteps[c]);
+    }
+
+    Closure(start);
+    if (hasUnanchored) start.push_back(kSegmentStart);
+
+    // 3) 시작 상태만 만들고 나머지는 매칭 중 처음 필요할 때 만든다.
+    blocks.resize((kMaxDfaStates + kStatesPerBlock - 1) / kStatesPerBlock);
+    AddState(std::move(start));
+}
+
+std::atomic<int32_t> &IgnoreRules::NextSlot(const int32_t state, const uint8_t inputClass) const
+{
+    const auto index = static_cast<size_t>(state);
+    return blocks[index / kStatesPerBlock]->next[(index % kStatesPerBlock) * classSample.size() + inputClass];
+}
+
+const IgnoreRules::DfaBlock &IgnoreRules::BlockOf(const int32_t state) const
+{
+    return *blocks[static_cast<size_t>(state) / kStatesPerBlock];
+}
+
+int32_t IgnoreRules::AddState(std::vector<Item> items) const
+{
+    // buildMutex 보유 상태(또는 Compile 중)에서만 호출된다.
+    if (stateCount >= kMaxDfaStates) return kUnbuiltState;
+
+    const auto id = static_cast<int32_t>(stateCount);
+    const size_t blockIndex = stateCount / kStatesPerBlock;
+    const size_t slot = stateCount % kStatesPerBlock;
+
+    auto &block = blocks[blockIndex];
+    if (!block)
+    {
+        const size_t slots = kStatesPerBlock * classSample.size();
+        block = std::make_unique<DfaBlock>();
+        block->next = std::make_unique<std::atomic<int32_t>[]>(slots);
+        for (size_t i = 0; i < slots; ++i)
+        {
+            block->next[i].store(kUnbuiltState, std::memory_order_relaxed);
+        }
+    }
+
+    block->info[slot] = Accepting(items);
+    stateIds.emplace(items, id);
+    block->items[slot] = std::move(items);
+    ++stateCount;
+    return id;
+}
+
+int32_t IgnoreRules::BuildTransition(const int32_t state, const uint8_t inputClass) const
+{
+    std::lock_guard<std::mutex> lock(buildMutex);
+
+    std::atomic<int32_t> &slot = NextSlot(state, inputClass);
+    if (const int32_t existing = slot.load(std::memory_order_relaxed); existing != kUnbuiltState)
+    {
+        return existing; // 다른 스레드가 먼저 만들었다
+    }
+
+    std::vector<Item> next = Step(BlockOf(state).items[state % kStatesPerBlock], classSample[inputClass]);
+
+    int32_t target;
+    if (next.empty())
+    {
+        target = kDeadState;
+    }
+    else if (const auto it = stateIds.find(next); it != stateIds.end())
+    {
+        target = it->second;
+    }
+    else
+    {
+        target = AddState(std::move(next));
+        if (target == kUnbuiltState) return kUnbuiltState; // 상한 초과 → 호출자가 NFA로 이어서 처리
+    }
+
+    // release: 새 상태의 블록/정보를 채운 뒤 공개한다 (읽는 쪽은 acquire).
+    slot.store(target, std::memory_order_release);
+    return target;
+}
+
+bool IgnoreRules::IsIgnoredBy(const int32_t ruleIndex) const
+{
+    return ruleIndex >= 0 && !rules[static_cast<size_t>(ruleIndex)].negate;
+}
+
+bool IgnoreRules::IsIgnored(const std::string &relativePath, const bool isDirectory) const
+{
+    if (!compiled || rules.empty() || relativePath.empty()) return false;
+
+    int32_t state = 0;
+
+    for (size_t i = 0; i < relativePath.size(); ++i)
+    {
+        const auto byte = static_cast<unsigned char>(relativePath[i]);
+        const DfaBlock &block = BlockOf(state);
+        const size_t slot = static_cast<size_t>(state) % kStatesPerBlock;
+
+        // '/' 직전까지가 상위 디렉토리. 상위가 무시되면 하위는 되살릴 수 없다 (git 규칙).
+        if (byte == '/' && IsIgnoredBy(block.info[slot].matchAny)) return true;
+
+        const uint8_t inputClass = byteClass[byte];
+        int32_t next = block.next[slot * classSample.size() + inputClass].load(std::memory_order_acquire);
+        if (next == kUnbuiltState)
+        {
+            next = BuildTransition(state, inputClass);
+        }
+        if (next == kDeadState) return false;
+        if (next == kUnbuiltState)
+        {
+            return IsIgnoredSlow(relativePath, i, block.items[slot], isDirectory);
+        }
+        state = next;
+    }
+
+    const StateInfo &info = BlockOf(state).info[static_cast<size_t>(state) % kStatesPerBlock];
+    return IsIgnoredBy(isDirectory ? info.matchAny : info.matchFile);
+}
+
+bool IgnoreRules::IsIgnoredSlow(const std::string &relativePath, const size_t offset,
+                                std::vector<Item> items, const bool isDirectory) const
+{
+    for (size_t i = offset; i < relativePath.size(); ++i)
+    {
+        const auto byte = FoldCase(static_cast<unsigned char>(relativePath[i]));
+        if (byte == '/' && i != offset && IsIgnoredBy(Accepting(items).matchAny)) return true;
+
+        items = Step(items, byte);
+        if (items.empty()) return false;
+    }
+
+    const StateInfo info = Accepting(items);
+    return IsIgnoredBy(isDirectory ? info.matchAny : info.matchFile);
+}
+
+#ifndef NDEBUG
+void IgnoreRules::SelfCheck()
+{
+    struct Case {
+        std::vector<std::string> patterns; // 비어 있으면 기본 규칙
+        std::string path;
+        bool isDirectory;
+        bool expected;
+    };
+    const Case cases[] = {
+        {{}, "Library/x.cs", false, true},
+        {{}, "Assets/Library/x.cs", false, true},
+        {{}, "Assets/Foo/Build/a.cs", false, true},
+        {{}, "Packages/obj/a.cs", false, true},
+        {{}, "Assets/Temp/a.cs", false, true},
+        {{}, "Assets/Foo/Temp", true, true},
+        {{}, "Assets/Foo/Temp", false, false},
+        {{}, "Assets/Libraryx/a.cs", false, false},
+        {{}, "Assets/Scripts/Player.cs", false, false},
+        {{"**/gen/**"}, "Assets/gen/x/a.cs", false, true},
+        {{"**/gen/**"}, "gen/a.cs", false, true},
+        {{"**/gen/**"}, "Assets/generated/a.cs", false, false},
+        {{"*.tmp"}, "Assets/Foo/a.tmp", false, true},
+        {{"/Assets/Gen/"}, "Packages/Assets/Gen/a.cs", false, false},
+    };
+
+    for (const Case &c : cases)
+    {
+        IgnoreRules rules;
+        if (c.patterns.empty())
+        {
+            for (const auto &folder : Config::IGNORE_FOLDERS) rules.AddPattern(folder + "/");
+        }
+        for (const auto &pattern : c.patterns) rules.AddPattern(pattern);
+        rules.Compile();
+
+        const bool dfa = rules.IsIgnored(c.path, c.isDirectory);
+        const bool nfa = rules.IsIgnoredSlow(c.path, 0, rules.BlockOf(0).items[0], c.isDirectory);
+        if (dfa != c.expected || nfa != c.expected)
+        {
+            WT_ERR("[IgnoreRules] Self-check failed for " << c.path << ": dfa=" << dfa << " nfa=" << nfa
+                                                           << " expected=" << c.expected);
+        }
+    }
+}
+#endif
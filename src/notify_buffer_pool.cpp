@@ -0,0 +1,84 @@
+#include "notify_buffer_pool.h"
+
+namespace
+{
+    size_t RoundUpPowerOfTwo(const size_t value)
+    {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+}
+
+NotifyBufferPool::NotifyBufferPool(const size_t minSize, const size_t maxSize, const size_t totalCap) :
+    minSize(RoundUpPowerOfTwo(std::max<size_t>(minSize, sizeof(DWORD)))),
+    maxSize(std::max(this->minSize, RoundUpPowerOfTwo(maxSize))),
+    totalCap(totalCap)
+{
+}
+
+NotifyBufferPool::Buffer NotifyBufferPool::Acquire(const size_t size)
+{
+    size_t granted = std::clamp(RoundUpPowerOfTwo(size), minSize, maxSize);
+
+    Buffer buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // 보관 버퍼를 재사용하면 메모리가 늘지 않는다. 새로 할당해야 하면 빌려준 것 + 보관분 + 새 버퍼가 상한 안이어야 한다.
+        const auto fits = [this](const size_t candidate)
+        {
+            if (const auto it = freeLists.find(candidate); it != freeLists.end() && !it->second.empty()) return true;
+            return bytesInUse + bytesRetained + candidate <= totalCap;
+        };
+
+        // 보관분은 캐시일 뿐이므로 상한에 걸리면 먼저 버린다.
+        if (!fits(granted) && bytesRetained > 0)
+        {
+            freeLists.clear();
+            bytesRetained = 0;
+        }
+
+        // 그래도 넘으면 절반씩 줄여 본다. 최소 크기는 상한과 관계없이 준다 (감시 자체를 못 하게 되지 않도록).
+        while (granted > minSize && !fits(granted))
+        {
+            granted >>= 1;
+        }
+        bytesInUse += granted;
+
+        if (auto it = freeLists.find(granted); it != freeLists.end() && !it->second.empty())
+        {
+            buffer.storage = std::move(it->second.back());
+            it->second.pop_back();
+            bytesRetained -= granted;
+        }
+    }
+
+    if (buffer.storage == nullptr)
+    {
+        buffer.storage = std::make_unique<DWORD[]>(granted / sizeof(DWORD));
+    }
+    buffer.owner = this;
+    buffer.size = granted;
+    return buffer;
+}
+
+size_t NotifyBufferPool::BytesInUse() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return bytesInUse;
+}
+
+void NotifyBufferPool::Return(std::unique_ptr<DWORD[]> storage, const size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    bytesInUse -= std::min(bytesInUse, size);
+
+    // 최소 크기 버퍼는 상한을 넘겨서도 빌려주므로, 보관은 상한 안일 때만 한다.
+    auto &freeList = freeLists[size];
+    if (freeList.size() < kMaxFreePerSize && bytesInUse + bytesRetained + size <= totalCap)
+    {
+        freeList.push_back(std::move(storage));
+        bytesRetained += size;
+    }
+}
@@ -0,0 +1,266 @@
+#include "open_file_resolver.h"
+#include <winternl.h>   // NtQueryInformationProcess
+#include <cwctype>
+
+namespace
+{
+    using NtQueryInformationProcess_t = NTSTATUS(NTAPI *)(
+        HANDLE, PROCESSINFOCLASS, PVOID, ULONG, PULONG);
+
+    NtQueryInformationProcess_t GetNtQueryInformationProcess()
+    {
+        static const auto fn = []() -> NtQueryInformationProcess_t
+        {
+            if (const HMODULE ntdll = GetModuleHandleW(L"ntdll.dll"))
+            {
+                return reinterpret_cast<NtQueryInformationProcess_t>(
+                    reinterpret_cast<void *>(GetProcAddress(ntdll, "NtQueryInformationProcess")));
+            }
+            return nullptr;
+        }();
+        return fn;
+    }
+
+    constexpr NTSTATUS kStatusInfoLengthMismatch = static_cast<NTSTATUS>(0xC0000004L);
+    // ProcessHandleInformation (Windows 8+). winternl.h의 PROCESSINFOCLASS에는 없다.
+    constexpr auto kProcessHandleInformation = static_cast<PROCESSINFOCLASS>(51);
+    constexpr size_t kInitialSnapshotBytes = 64 * 1024;
+
+    // PROCESS_HANDLE_TABLE_ENTRY_INFO / PROCESS_HANDLE_SNAPSHOT_INFORMATION (ntpsapi.h)
+    struct HandleEntry {
+        HANDLE HandleValue;
+        ULONG_PTR HandleCount;
+        ULONG_PTR PointerCount;
+        ULONG GrantedAccess;
+        ULONG ObjectTypeIndex;
+        ULONG HandleAttributes;
+        ULONG Reserved;
+    };
+
+    struct HandleSnapshot {
+        ULONG_PTR NumberOfHandles;
+        ULONG_PTR Reserved;
+        HandleEntry Handles[1];
+    };
+
+    std::wstring Utf8ToWide(const std::string& s)
+    {
+        if (s.empty()) return L"";
+        const int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (len <= 1) return L"";
+        std::wstring w(static_cast<size_t>(len), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), len);
+        w.resize(static_cast<size_t>(len - 1));
+        return w;
+    }
+
+    std::string WideToUtf8(const std::wstring& w)
+    {
+        if (w.empty()) return "";
+        const int len = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                                            nullptr, 0, nullptr, nullptr);
+        if (len <= 0) return "";
+        std::string s(static_cast<size_t>(len), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                            s.data(), len, nullptr, nullptr);
+        return s;
+    }
+
+    // "\\?\C:\a" → "C:\a", "\\?\UNC\server\share" → "\\server\share"
+    std::wstring StripVerbatimPrefix(std::wstring path)
+    {
+        if (path.compare(0, 8, L"\\\\?\\UNC\\") == 0) return L"\\" + path.substr(7);
+        if (path.compare(0, 4, L"\\\\?\\") == 0) return path.substr(4);
+        return path;
+    }
+
+    // 경로의 파일 이름이 name과 같은지 (대소문자 무시)
+    bool LeafEquals(const std::wstring& path, const std::wstring& name)
+    {
+        const size_t slash = path.find_last_of(L"/\\");
+        const size_t start = slash == std::wstring::npos ? 0 : slash + 1;
+        if (path.size() - start != name.size()) return false;
+        return std::equal(name.begin(), name.end(), path.begin() + static_cast<std::ptrdiff_t>(start),
+                          [](const wchar_t a, const wchar_t b) { return std::towlower(a) == std::towlower(b); });
+    }
+
+    bool HasExtension(const std::wstring& path, const std::vector<std::string>& extensions)
+    {
+        if (extensions.empty()) return true;
+
+        const size_t slash = path.find_last_of(L"/\\");
+        const size_t dot = path.find_last_of(L'.');
+        if (dot == std::wstring::npos || (slash != std::wstring::npos && dot < slash)) return false;
+
+        std::string ext;
+        for (size_t i = dot; i < path.size(); ++i)
+        {
+            const wchar_t c = path[i];
+            if (c > 0x7F) return false; // 확장자는 ASCII만 등록돼 있다
+            ext.push_back(static_cast<char>(::tolower(static_cast<unsigned char>(c))));
+        }
+
+        return std::any_of(extensions.begin(), extensions.end(), [&ext](const std::string& candidate)
+        {
+            return candidate.size() == ext.size() &&
+                   std::equal(candidate.begin(), candidate.end(), ext.begin(), [](const char a, const char b)
+                   {
+                       return ::tolower(static_cast<unsigned char>(a)) == b;
+                   });
+        });
+    }
+}
+
+std::string OpenFileResolver::Resolve(const DWORD pid, const uint64_t createTime, const std::vector<std::string> &extensions,
+                                     const std::string &titleName)
+{
+    State &state = states[pid];
+    if (state.createTime != createTime)
+    {
+        state = State{}; // PID 재사용: 다른 프로세스
+        state.createTime = createTime;
+    }
+
+    const std::wstring title = Utf8ToWide(titleName);
+    const auto now = std::chrono::steady_clock::now();
+    if (state.scanned && now - state.lastScan < kMinScanInterval)
+    {
+        // 다시 스캔하지 않아도 제목이 바뀌었으면 이미 본 핸들 중에서 고를 수 있다.
+        if (const std::wstring *titled = FindTitled(state, title))
+        {
+            state.latest = WideToUtf8(StripVerbatimPrefix(*titled));
+        }
+        return state.latest;
+    }
+
+    state.scanned = true;
+    state.lastScan = now;
+    Scan(pid, state, extensions, title);
+    return state.latest;
+}
+
+void OpenFileResolver::Forget(const DWORD pid)
+{
+    states.erase(pid);
+}
+
+void OpenFileResolver::Scan(const DWORD pid, State &state, const std::vector<std::string> &extensions,
+                            const std::wstring &titleName)
+{
+    const auto NtQueryInformationProcess = GetNtQueryInformationProcess();
+    if (NtQueryInformationProcess == nullptr) return;
+
+    const HANDLE hProcess = OpenProcess(PROCESS_QUERY_INFORMATION | PROCESS_DUP_HANDLE, FALSE, pid);
+    if (hProcess == nullptr) return;
+
+    if (snapshotBuffer.empty()) snapshotBuffer.resize(kInitialSnapshotBytes);
+
+    NTSTATUS status = 0;
+    for (int attempt = 0; attempt < 4; ++attempt)
+    {
+        ULONG needed = 0;
+        status = NtQueryInformationProcess(hProcess, kProcessHandleInformation, snapshotBuffer.data(),
+                                           static_cast<ULONG>(snapshotBuffer.size()), &needed);
+        if (status != kStatusInfoLengthMismatch) break;
+        snapshotBuffer.resize(std::max<size_t>(snapshotBuffer.size() * 2, needed + kInitialSnapshotBytes));
+    }
+    if (status < 0)
+    {
+        CloseHandle(hProcess);
+        return;
+    }
+
+    const auto *snapshot = reinterpret_cast<const HandleSnapshot *>(snapshotBuffer.data());
+    std::unordered_map<ULONG_PTR, std::wstring> current;
+    current.reserve(static_cast<size_t>(snapshot->NumberOfHandles));
+
+    std::vector<std::wstring> added; // 이번 스캔에 새로 생긴, 확장자가 맞는 파일
+    size_t probes = 0;
+    for (ULONG_PTR i = 0; i < snapshot->NumberOfHandles; ++i)
+    {
+        const HandleEntry &entry = snapshot->Handles[i];
+        const auto value = reinterpret_cast<ULONG_PTR>(entry.HandleValue);
+
+        // 상한을 넘은 새 핸들은 본 것으로 치지 않는다 (다음 스캔에서 이어서 본다).
+        const auto seen = state.handles.find(value);
+        if (seen == state.handles.end() && probes >= kMaxProbesPerScan) continue;
+
+        // 직전 스캔에 있던 핸들은 이미 봤다. 파일 타입을 알면 다른 타입은 열어 보지 않는다.
+        if (seen != state.handles.end())
+        {
+            current.emplace(value, std::move(seen->second));
+            continue;
+        }
+        std::wstring &path = current[value];
+        if (fileTypeKnown && entry.ObjectTypeIndex != fileTypeIndex) continue;
+        ++probes;
+
+        path = ProbeHandle(hProcess, entry.HandleValue, entry.ObjectTypeIndex);
+        if (path.empty()) continue;
+        if (!HasExtension(path, extensions))
+        {
+            path.clear();
+            continue;
+        }
+        added.push_back(path);
+    }
+    CloseHandle(hProcess);
+
+    state.handles.swap(current);
+
+    // 핸들 값 순서는 열린 순서가 아니다 (닫힌 자리를 재사용). 제목과 맞는 핸들을 먼저 보고,
+    // 없으면 새 후보가 하나일 때만 채택한다. 첫 스캔의 리소스 파일처럼 후보가 여럿이면 추측하지 않는다.
+    if (const std::wstring *titled = FindTitled(state, titleName))
+    {
+        state.latest = WideToUtf8(StripVerbatimPrefix(*titled));
+    }
+    else if (added.size() == 1)
+    {
+        state.latest = WideToUtf8(StripVerbatimPrefix(std::move(added.front())));
+    }
+}
+
+const std::wstring *OpenFileResolver::FindTitled(const State &state, const std::wstring &titleName)
+{
+    if (titleName.empty()) return nullptr;
+    for (const auto &[value, path] : state.handles)
+    {
+        if (!path.empty() && LeafEquals(path, titleName)) return &path;
+    }
+    return nullptr;
+}
+
+std::wstring OpenFileResolver::ProbeHandle(const HANDLE process, const HANDLE handle, const ULONG typeIndex)
+{
+    HANDLE local = nullptr;
+    if (!DuplicateHandle(process, handle, GetCurrentProcess(), &local, 0, FALSE, DUPLICATE_SAME_ACCESS))
+    {
+        return L"";
+    }
+
+    std::wstring path;
+    if (GetFileType(local) == FILE_TYPE_DISK)
+    {
+        if (!fileTypeKnown)
+        {
+            fileTypeIndex = typeIndex;
+            fileTypeKnown = true;
+        }
+
+        WCHAR buf[MAX_PATH];
+        if (const DWORD len = GetFinalPathNameByHandleW(local, buf, MAX_PATH, FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+            len > 0 && len < MAX_PATH)
+        {
+            path.assign(buf, len);
+        }
+        else if (len >= MAX_PATH)
+        {
+            path.resize(len);
+            const DWORD written = GetFinalPathNameByHandleW(local, path.data(), len, FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+            path.resize(written < len ? written : 0);
+        }
+    }
+
+    CloseHandle(local);
+    return path;
+}
@@ -0,0 +1,82 @@
+#include "process_activity_sampler.h"
+
+namespace
+{
+    uint64_t FileTimeToUInt64(const FILETIME &time)
+    {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    }
+}
+
+ProcessActivity ProcessActivitySampler::Sample(const DWORD pid)
+{
+    ProcessActivity activity;
+
+    Counters current;
+    if (!ReadCounters(pid, current))
+    {
+        baselines.erase(pid);
+        return activity;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto it = baselines.find(pid);
+    if (it == baselines.end() || it->second.counters.createTime != current.createTime)
+    {
+        // 첫 샘플이거나 PID가 재사용됐다: 기준점만 잡는다.
+        if (it == baselines.end() && baselines.size() >= kMaxBaselines) baselines.clear();
+        baselines[pid] = Baseline{current, now};
+        return activity;
+    }
+    if (now - it->second.at < kMinWindow) return activity; // 구간이 너무 짧다: 기준점을 유지해 다음 구간에 합친다
+
+    const Counters &previous = it->second.counters;
+    const double elapsed100ns = std::chrono::duration<double>(now - it->second.at).count() * 1e7;
+
+    activity.known = true;
+    activity.cpuCores = current.cpuTime >= previous.cpuTime
+        ? static_cast<double>(current.cpuTime - previous.cpuTime) / elapsed100ns
+        : 0.0;
+    activity.readBytes = current.readBytes >= previous.readBytes ? current.readBytes - previous.readBytes : 0;
+    activity.active = activity.cpuCores >= kActiveCpuCores || activity.readBytes >= kActiveReadBytes;
+    activity.rendering = activity.cpuCores >= kRenderCpuCores;
+
+    it->second = Baseline{current, now};
+    return activity;
+}
+
+void ProcessActivitySampler::Reset(const DWORD pid)
+{
+    Counters current;
+    if (!ReadCounters(pid, current))
+    {
+        baselines.erase(pid);
+        return;
+    }
+
+    if (baselines.size() >= kMaxBaselines && baselines.find(pid) == baselines.end()) baselines.clear();
+    baselines[pid] = Baseline{current, std::chrono::steady_clock::now()};
+}
+
+void ProcessActivitySampler::Forget(const DWORD pid)
+{
+    baselines.erase(pid);
+}
+
+bool ProcessActivitySampler::ReadCounters(const DWORD pid, Counters &counters)
+{
+    const HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (hProcess == nullptr) return false;
+
+    FILETIME creation{}, exitTime{}, kernel{}, user{};
+    IO_COUNTERS io{};
+    const bool ok = GetProcessTimes(hProcess, &creation, &exitTime, &kernel, &user) &&
+                    GetProcessIoCounters(hProcess, &io);
+    CloseHandle(hProcess);
+    if (!ok) return false;
+
+    counters.createTime = FileTimeToUInt64(creation);
+    counters.cpuTime = FileTimeToUInt64(kernel) + FileTimeToUInt64(user);
+    counters.readBytes = io.ReadTransferCount;
+    return true;
+}
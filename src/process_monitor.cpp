@@ -2,6 +2,8 @@
 #include <tlhelp32.h>   // Windows 프로세스 스냅샷 API
 #include <winternl.h>   // NtQueryInformationProcess, PEB, RTL_USER_PROCESS_PARAMETERS
 #include <shellapi.h>   // CommandLineToArgvW
+#include <cstring>
+#include <iterator>
 
 namespace
 {
@@ -23,6 +25,34 @@ namespace
         return fn;
     }
 
+    using NtQuerySystemInformation_t = NTSTATUS(NTAPI *)(
+        SYSTEM_INFORMATION_CLASS, PVOID, ULONG, PULONG);
+
+    NtQuerySystemInformation_t GetNtQuerySystemInformation()
+    {
+        static const auto fn = []() -> NtQuerySystemInformation_t
+        {
+            if (const HMODULE ntdll = GetModuleHandleW(L"ntdll.dll"))
+            {
+                return reinterpret_cast<NtQuerySystemInformation_t>(
+                    reinterpret_cast<void *>(GetProcAddress(ntdll, "NtQuerySystemInformation")));
+            }
+            return nullptr;
+        }();
+        return fn;
+    }
+
+    constexpr NTSTATUS kStatusInfoLengthMismatch = static_cast<NTSTATUS>(0xC0000004L);
+    // ProcessCommandLineInformation (Windows 8.1+). winternl.h의 PROCESSINFOCLASS에는 없다.
+    constexpr auto kProcessCommandLineInformation = static_cast<PROCESSINFOCLASS>(60);
+    // 프로세스 2000개 안팎이 한 번에 들어가는 크기에서 시작한다.
+    constexpr size_t kInitialSnapshotBytes = 1024 * 1024;
+    constexpr size_t kSnapshotSlackBytes = 64 * 1024;
+    constexpr size_t kInitialCommandLineBytes = 4096;
+    // SYSTEM_PROCESS_INFORMATION::Reserved1 안의 CreateTime 위치
+    // (WorkingSetPrivateSize, HardFaultCount, NumberOfThreadsHighWatermark, CycleTime 다음)
+    constexpr size_t kCreateTimeOffset = 24;
+
     std::wstring Utf8ToWide(const std::string& s)
     {
         if (s.empty()) return L"";
@@ -100,20 +130,67 @@ namespace
 
 ProcessMonitor::ProcessMonitor()
 {
+    for (size_t i = 0; i < kResolverThreads; ++i)
+    {
+        resolverThreads.emplace_back(&ProcessMonitor::ResolverThreadFunction, this);
+    }
     WT_LOG("[ProcessMonitor] Initialized");
 }
 
 ProcessMonitor::~ProcessMonitor()
 {
+    // 워커를 먼저 멈춘다 (진행 중인 해석은 끝까지 돌고, 남은 작업은 버린다).
+    {
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        resolverStopping = true;
+    }
+    resolveCv.notify_all();
+    for (auto &thread : resolverThreads)
+    {
+        if (thread.joinable()) thread.join();
+    }
+
+    for (auto &[pid, watch] : exitWatches)
+    {
+        UnregisterWaitEx(watch->wait, INVALID_HANDLE_VALUE);
+        CloseHandle(watch->process);
+    }
+    exitWatches.clear();
     activeInstances.clear();
     WT_LOG("[ProcessMonitor] Destroyed");
 }
 
-std::string ProcessMonitor::GetCommandLineViaPeb(const DWORD pid)
+std::string ProcessMonitor::ReadCommandLine(const DWORD pid)
 {
     const auto NtQueryInformationProcess = GetNtQueryInformationProcess();
     if (NtQueryInformationProcess == nullptr) return "";
 
+    // 1차: ProcessCommandLineInformation. 호출 1회, PROCESS_VM_READ 불필요. 재사용 버퍼에 UNICODE_STRING + 본문이 온다.
+    thread_local std::vector<unsigned char> commandLineBuffer;
+    if (const HANDLE hQuery = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid))
+    {
+        if (commandLineBuffer.empty()) commandLineBuffer.resize(kInitialCommandLineBytes);
+
+        ULONG needed = 0;
+        NTSTATUS status = NtQueryInformationProcess(hQuery, kProcessCommandLineInformation, commandLineBuffer.data(),
+                                                    static_cast<ULONG>(commandLineBuffer.size()), &needed);
+        if (status == kStatusInfoLengthMismatch && needed > commandLineBuffer.size())
+        {
+            commandLineBuffer.resize(needed);
+            status = NtQueryInformationProcess(hQuery, kProcessCommandLineInformation, commandLineBuffer.data(),
+                                               static_cast<ULONG>(commandLineBuffer.size()), &needed);
+        }
+        CloseHandle(hQuery);
+
+        if (status >= 0)
+        {
+            const auto *text = reinterpret_cast<const UNICODE_STRING *>(commandLineBuffer.data());
+            if (text->Buffer == nullptr || text->Length == 0) return "";
+            return WideToUtf8(std::wstring(text->Buffer, text->Length / sizeof(WCHAR)));
+        }
+    }
+
+    // 2차(구버전 Windows): PEB를 따라가 읽는다.
     const HANDLE hProcess = OpenProcess(
         PROCESS_QUERY_LIMITED_INFORMATION | PROCESS_VM_READ, FALSE, pid);
     if (hProcess == nullptr) return "";
@@ -203,18 +280,31 @@ bool ProcessMonitor::ResolveInstance(const DWORD pid, const AppDefinition& def,
 
     if (def.cmdLineEntity == CmdLineEntity::UnityProjectPath)
     {
-        const std::string commandLine = GetCommandLineViaPeb(pid);
+        const std::string commandLine = ReadCommandLine(pid);
         if (commandLine.empty()) return false;
 
         std::string projectPath = ExtractProjectPath(commandLine);
-        if (projectPath.empty() || !IsUnityProject(projectPath))
+        const ProjectMetadata metadata = projectPath.empty()
+            ? ProjectMetadata{}
+            : projectMetadata.Get(projectPath, [this](const std::string &path)
+            {
+                ProjectMetadata loaded;
+                loaded.valid = IsUnityProject(path);
+                if (loaded.valid)
+                {
+                    loaded.projectName = GetLeafName(path);
+                    loaded.editorVersion = GetUnityEditorVersion(path);
+                }
+                return loaded;
+            });
+        if (!metadata.valid)
         {
             WT_LOG("[ProcessMonitor] Not a valid Unity project for PID " << pid);
             return false;
         }
 
-        instance.projectName = GetLeafName(projectPath);
-        instance.editorVersion = GetUnityEditorVersion(projectPath);
+        instance.projectName = metadata.projectName;
+        instance.editorVersion = metadata.editorVersion;
         instance.projectPath = std::move(projectPath);
         return true;
     }
@@ -222,7 +312,7 @@ bool ProcessMonitor::ResolveInstance(const DWORD pid, const AppDefinition& def,
     if (def.cmdLineEntity == CmdLineEntity::PositionalFile)
     {
         // WindowTitle 앱: 프로세스 존재만으로 추적 대상. 커맨드라인 파일은 초기 entity(선택적).
-        const std::string commandLine = GetCommandLineViaPeb(pid);
+        const std::string commandLine = ReadCommandLine(pid);
         if (const std::string file = commandLine.empty() ? "" : ExtractPositionalFile(commandLine, def);
             !file.empty())
         {
@@ -236,15 +326,52 @@ bool ProcessMonitor::ResolveInstance(const DWORD pid, const AppDefinition& def,
     return true;
 }
 
-std::vector<AppInstance> ProcessMonitor::ScanProcesses()
+bool ProcessMonitor::ForEachProcess(const std::function<void(DWORD, std::wstring_view, uint64_t, DWORD)> &visit)
 {
-    std::vector<AppInstance> foundInstances;
+    // 1차: NtQuerySystemInformation 한 번으로 전체 목록을 재사용 버퍼에 받는다 (이름은 복사하지 않는다).
+    if (const auto NtQuerySystemInformation = GetNtQuerySystemInformation())
+    {
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            if (snapshotBuffer.empty()) snapshotBuffer.resize(kInitialSnapshotBytes);
 
+            ULONG needed = 0;
+            const NTSTATUS status = NtQuerySystemInformation(SystemProcessInformation, snapshotBuffer.data(),
+                                                             static_cast<ULONG>(snapshotBuffer.size()), &needed);
+            if (status == kStatusInfoLengthMismatch)
+            {
+                // 조회와 다음 호출 사이에도 프로세스가 늘 수 있으므로 여유를 둔다.
+                snapshotBuffer.resize(std::max<size_t>(snapshotBuffer.size() * 2, needed + kSnapshotSlackBytes));
+                continue;
+            }
+            if (status < 0) break;
+
+            const unsigned char *cursor = snapshotBuffer.data();
+            while (true)
+            {
+                const auto *info = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION *>(cursor);
+                const auto pid = static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(info->UniqueProcessId));
+                if (pid != 0 && info->ImageName.Buffer != nullptr)
+                {
+                    uint64_t createTime = 0;
+                    std::memcpy(&createTime, info->Reserved1 + kCreateTimeOffset, sizeof(createTime));
+                    // Reserved2 = InheritedFromUniqueProcessId
+                    const auto parent = static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(info->Reserved2));
+                    visit(pid, std::wstring_view(info->ImageName.Buffer, info->ImageName.Length / sizeof(WCHAR)), createTime, parent);
+                }
+                if (info->NextEntryOffset == 0) break;
+                cursor += info->NextEntryOffset;
+            }
+            return true;
+        }
+    }
+
+    // 2차: Toolhelp 스냅샷
     const HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
     if (hSnapshot == INVALID_HANDLE_VALUE)
     {
         WT_ERR("[ProcessMonitor] CreateToolhelp32Snapshot failed");
-        return foundInstances;
+        return false;
     }
 
     PROCESSENTRY32W entry;
@@ -254,102 +381,568 @@ std::vector<AppInstance> ProcessMonitor::ScanProcesses()
     {
         do
         {
-            const AppDefinition* def = AppRegistry::FindByProcessName(entry.szExeFile);
-            if (def == nullptr || !AppRegistry::IsEnabled(def->id)) continue;
-
-            if (AppInstance instance; ResolveInstance(entry.th32ProcessID, *def, instance))
-            {
-                activeInstances[instance.processId] = instance;
-                foundInstances.push_back(std::move(instance));
-            }
+            visit(entry.th32ProcessID, entry.szExeFile, 0, entry.th32ParentProcessID);
         } while (Process32NextW(hSnapshot, &entry));
     }
 
     CloseHandle(hSnapshot);
+    return true;
+}
 
-    WT_LOG("[ProcessMonitor] Scan complete. Found " << foundInstances.size() << " app instances");
-    return foundInstances;
+size_t ProcessMonitor::ScanProcesses()
+{
+    // 보조 스캔과 같은 경로 (추적 중인 인스턴스가 없으므로 종료는 나오지 않는다). 트리로 보조 프로세스를 거른다.
+    const size_t before = pendingPids.size();
+    std::vector<AppInstance> closed;
+    ScanSnapshot(closed);
+    const size_t submitted = pendingPids.size() - before;
+
+    WT_LOG("[ProcessMonitor] Scan complete. Resolving " << submitted << " app processes, "
+           << helperRoots.size() << " helper processes");
+    return submitted;
 }
 
-void ProcessMonitor::PollChanges(std::vector<AppInstance>& started, std::vector<AppInstance>& closed)
+void ProcessMonitor::PollChanges(std::vector<AppInstance>& closed)
 {
-    const HANDLE hSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
-    if (hSnapshot == INVALID_HANDLE_VALUE)
+    const auto began = std::chrono::steady_clock::now();
+    ++scanStats.wakeups;
+
+    uint32_t nextInterval;
+    if (AllEnabledAppsLive())
     {
-        WT_ERR("[ProcessMonitor] CreateToolhelp32Snapshot failed");
-        return;
+        // 새 인스턴스는 창 표시 훅이 잡으므로 종료 대기를 못 건 인스턴스만 보면 된다.
+        ++scanStats.livenessChecks;
+        const size_t before = closed.size();
+        CheckLiveness(closed);
+        nextInterval = closed.size() != before ? kScanMinIntervalMs : kScanMaxIntervalMs;
+    }
+    else
+    {
+        ++scanStats.fullScans;
+        // 변화가 있으면 하한으로, 없으면 두 배씩 (상한까지)
+        nextInterval = ScanSnapshot(closed) ? kScanMinIntervalMs : std::min(scanIntervalMs * 2, kScanMaxIntervalMs);
     }
 
-    // 1) 현재 살아 있는 활성 앱 PID → 정의 매핑 (exe 이름 비교 — 저비용)
-    std::unordered_map<DWORD, const AppDefinition*> currentPids;
+    scanStats.scanMicros += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - began).count());
+    SetScanInterval(nextInterval);
+}
 
-    PROCESSENTRY32W entry;
-    entry.dwSize = sizeof(PROCESSENTRY32W);
+bool ProcessMonitor::ScanSnapshot(std::vector<AppInstance>& closed)
+{
+    // 1) 현재 살아 있는 활성 앱 PID → (정의, 생성 시각) 매핑 (exe 이름 비교 — 저비용), 같은 순회로 전체 프로세스 트리
+    std::unordered_map<DWORD, std::pair<const AppDefinition*, uint64_t>> currentPids;
+    std::unordered_map<DWORD, ProcessNode> tree;
+    tree.reserve(512);
+    const bool listed = ForEachProcess([&currentPids, &tree](const DWORD pid, const std::wstring_view exe,
+                                                             const uint64_t createTime, const DWORD parent)
+    {
+        const AppDefinition* app = AppRegistry::FindByHelperName(exe);
+        tree.emplace(pid, ProcessNode{parent, createTime, app});
+        if (app == nullptr) return;
+
+        const AppDefinition* def = AppRegistry::FindByProcessName(exe);
+        if (def == nullptr || !AppRegistry::IsEnabled(def->id)) return;
+        currentPids[pid] = {def, createTime};
+    });
+    if (!listed) return false;
+
+    // 종료된 프로세스의 해석 실패 기록은 버린다 (캐시가 살아 있는 프로세스 수를 넘지 않게).
+    for (auto it = unresolved.begin(); it != unresolved.end();)
+    {
+        if (currentPids.find(it->first) == currentPids.end()) it = unresolved.erase(it);
+        else ++it;
+    }
 
-    if (Process32FirstW(hSnapshot, &entry))
+    // 창 표시 훅의 negative 캐시는 여기서 비운다 (그 사이 PID 재사용/앱 활성화 반영).
+    checkedPids.clear();
+
+    // 2) 사라졌거나 다른 프로세스로 재사용된 PID는 종료로 판정 (동일 스냅샷으로 diff). 보통은 종료 대기가 먼저 잡는다.
+    //    새 인스턴스 해석보다 먼저 해서, 재사용된 PID가 아래에서 새 인스턴스로 잡히게 한다.
+    std::vector<DWORD> gone;
+    for (const auto &[pid, instance] : activeInstances)
     {
-        do
+        const auto current = currentPids.find(pid);
+        const bool reused = current != currentPids.end() && instance.createTime != 0 &&
+                            current->second.second != 0 && current->second.second != instance.createTime;
+        if (current == currentPids.end() || reused)
         {
-            const AppDefinition* def = AppRegistry::FindByProcessName(entry.szExeFile);
-            if (def == nullptr || !AppRegistry::IsEnabled(def->id)) continue;
-            currentPids[entry.th32ProcessID] = def;
-        } while (Process32NextW(hSnapshot, &entry));
+            closed.push_back(instance);
+            gone.push_back(pid);
+        }
+    }
+    for (const DWORD pid : gone)
+    {
+        Untrack(pid);
     }
 
-    CloseHandle(hSnapshot);
+    // 3) 새로 등장한 PID만 해석 워커에 넘긴다 (추적/대기 중이거나 이미 실패한 프로세스는 건너뛴다).
+    //    추적 앱 exe라도 루트 인스턴스의 자손(Unity AssetImportWorker, Blender 렌더 서브프로세스)이면 넘기지 않는다.
+    //    부모가 먼저 대기 상태가 되도록 오래된 프로세스부터 본다.
+    std::vector<std::pair<uint64_t, DWORD>> candidates;
+    candidates.reserve(currentPids.size());
+    for (const auto& [pid, candidate] : currentPids)
+    {
+        if (activeInstances.find(pid) == activeInstances.end()) candidates.emplace_back(candidate.second, pid);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    size_t submitted = 0;
+    for (const auto& [createTime, pid] : candidates)
+    {
+        if (FindTreeRoot(pid, tree) != 0) continue;
+        if (SubmitResolve(pid, createTime, *currentPids[pid].first)) ++submitted;
+    }
+
+    // 4) 보조 프로세스 색인 (방금 대기 상태가 된 루트 포함)
+    IndexHelpers(tree);
+    return !gone.empty() || submitted > 0;
+}
+
+bool ProcessMonitor::IsRootPid(const DWORD pid) const
+{
+    return activeInstances.find(pid) != activeInstances.end() || pendingPids.find(pid) != pendingPids.end();
+}
+
+DWORD ProcessMonitor::FindTreeRoot(const DWORD pid, const std::unordered_map<DWORD, ProcessNode> &tree) const
+{
+    const auto self = tree.find(pid);
+    if (self == tree.end() || self->second.app == nullptr) return 0;
+
+    const AppDefinition* app = self->second.app;
+    uint64_t childTime = self->second.createTime;
+    DWORD current = pid;
+    DWORD parent = self->second.parent;
+    for (size_t depth = 0; depth < kMaxTreeDepth && parent != 0 && parent != current; ++depth)
+    {
+        const auto up = tree.find(parent);
+        if (up == tree.end()) return 0;
+        if (up->second.createTime != 0 && childTime != 0 && up->second.createTime > childTime) return 0;
+        if (up->second.app != app) return 0; // 다른 exe를 거친 자손 (에디터가 띄운 IDE, 브라우저 등)
+        if (IsRootPid(parent)) return parent;
+
+        current = parent;
+        childTime = up->second.createTime;
+        parent = up->second.parent;
+    }
+    return 0;
+}
+
+void ProcessMonitor::IndexHelpers(const std::unordered_map<DWORD, ProcessNode> &tree)
+{
+    helperRoots.clear();
+    for (const auto &[pid, node] : tree)
+    {
+        if (IsRootPid(pid)) continue;
+        if (const DWORD root = FindTreeRoot(pid, tree); root != 0)
+        {
+            helperRoots.emplace(pid, HelperLink{root, node.createTime});
+        }
+    }
+}
+
+const AppInstance* ProcessMonitor::FindHelperRoot(const DWORD pid, const std::wstring_view exe)
+{
+    if (const auto it = helperRoots.find(pid); it != helperRoots.end())
+    {
+        const auto root = activeInstances.find(it->second.root);
+        if (root != activeInstances.end() &&
+            (it->second.createTime == 0 || GetProcessCreateTime(pid) == it->second.createTime))
+        {
+            return &root->second;
+        }
+        helperRoots.erase(it); // 루트가 끝났거나 PID가 재사용됐다
+    }
+
+    // 마지막 스냅샷 이후에 생긴 자식: 루트 앱의 exe이고, 부모가 인스턴스이거나 이미 색인된 보조 프로세스일 때만 잇는다.
+    const AppDefinition* app = exe.empty() ? nullptr : AppRegistry::FindByHelperName(exe);
+    if (app == nullptr) return nullptr;
+
+    const DWORD parent = GetParentProcessId(pid);
+    if (parent == 0) return nullptr;
 
-    // 2) 새로 등장한 PID만 비싼 해석 수행
-    for (const auto& [pid, def] : currentPids)
+    DWORD root = 0;
+    uint64_t parentTime = 0;
+    if (const auto it = activeInstances.find(parent); it != activeInstances.end())
     {
+        root = parent;
+        parentTime = it->second.createTime;
+    }
+    else if (const auto helper = helperRoots.find(parent); helper != helperRoots.end())
+    {
+        root = helper->second.root;
+        parentTime = helper->second.createTime;
+    }
+    const auto rootInstance = activeInstances.find(root);
+    if (root == 0 || rootInstance == activeInstances.end() || rootInstance->second.appId != app->id) return nullptr;
+
+    const uint64_t createTime = GetProcessCreateTime(pid);
+    if (createTime != 0 && parentTime != 0 && parentTime > createTime) return nullptr; // 부모 PID 재사용
+
+    if (helperRoots.size() >= kMaxHelpers) helperRoots.clear();
+    helperRoots.emplace(pid, HelperLink{root, createTime});
+    WT_LOG("[ProcessMonitor] PID " << pid << " is a helper of " << rootInstance->second.appId << " PID " << root);
+    return &rootInstance->second;
+}
+
+DWORD ProcessMonitor::GetParentProcessId(const DWORD pid)
+{
+    const auto NtQueryInformationProcess = GetNtQueryInformationProcess();
+    if (NtQueryInformationProcess == nullptr) return 0;
+
+    const HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (hProcess == nullptr) return 0;
+
+    PROCESS_BASIC_INFORMATION pbi;
+    ZeroMemory(&pbi, sizeof(pbi));
+    ULONG returnLength = 0;
+    const NTSTATUS status = NtQueryInformationProcess(hProcess, ProcessBasicInformation, &pbi, sizeof(pbi), &returnLength);
+    CloseHandle(hProcess);
+
+    // Reserved3 = InheritedFromUniqueProcessId
+    return status < 0 ? 0 : static_cast<DWORD>(reinterpret_cast<ULONG_PTR>(pbi.Reserved3));
+}
+
+void ProcessMonitor::CheckLiveness(std::vector<AppInstance>& closed)
+{
+    std::vector<DWORD> gone;
+    for (const auto &[pid, instance] : activeInstances)
+    {
+        // 종료 대기가 걸린 인스턴스는 핸들 상태만, 아니면 PID로 연다.
+        const bool watched = exitWatches.find(pid) != exitWatches.end();
+        if (IsStale(pid, instance) || (!watched && !IsProcessRunning(pid)))
+        {
+            closed.push_back(instance);
+            gone.push_back(pid);
+        }
+    }
+    for (const DWORD pid : gone)
+    {
+        Untrack(pid);
+    }
+}
+
+bool ProcessMonitor::AllEnabledAppsLive() const
+{
+    const std::unordered_set<std::string> live = GetActiveAppIds();
+    for (const auto &def : AppRegistry::All())
+    {
+        if (AppRegistry::IsEnabled(def.id) && live.find(def.id) == live.end()) return false;
+    }
+    return true;
+}
+
+void ProcessMonitor::SetScanInterval(const uint32_t intervalMs)
+{
+    if (intervalMs == scanIntervalMs) return;
+    scanIntervalMs = intervalMs;
+    if (scanIntervalCallback) scanIntervalCallback(intervalMs);
+}
+
+void ProcessMonitor::TightenScan()
+{
+    SetScanInterval(kScanMinIntervalMs);
+}
+
+void ProcessMonitor::SetScanIntervalCallback(const std::function<void(uint32_t)> &callback)
+{
+    scanIntervalCallback = callback;
+}
+
+ProcessScanStats ProcessMonitor::GetScanStats() const
+{
+    ProcessScanStats stats = scanStats;
+    stats.intervalMs = scanIntervalMs;
+    return stats;
+}
+
+void ProcessMonitor::InvalidateProjectMetadata(const std::string &projectPath)
+{
+    projectMetadata.Invalidate(projectPath);
+    WT_LOG("[ProcessMonitor] Project metadata changed: " << projectPath);
+}
+
+void ProcessMonitor::SetLifecycleCallback(const std::function<void()> &callback)
+{
+    lifecycleNotify = callback;
+}
+
+void ProcessMonitor::CollectExited(std::vector<AppInstance> &closed)
+{
+    for (auto &instance : staleInstances)
+    {
+        closed.push_back(std::move(instance));
+    }
+    staleInstances.clear();
+
+    std::vector<DWORD> pids;
+    {
+        std::lock_guard<std::mutex> lock(exitedMutex);
+        pids.swap(exitedPids);
+    }
+
+    for (const DWORD pid : pids)
+    {
+        const auto it = activeInstances.find(pid);
+        if (it == activeInstances.end()) continue;
+
+        closed.push_back(it->second);
+        Untrack(pid);
+    }
+}
+
+void ProcessMonitor::CollectResolved(std::vector<AppInstance> &started)
+{
+    std::vector<ResolveResult> results;
+    {
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        results.swap(resolveResults);
+    }
+
+    for (auto &result : results)
+    {
+        AppInstance &instance = result.instance;
+        const DWORD pid = instance.processId;
+        pendingPids.erase(pid);
+
+        if (!result.resolved)
+        {
+            // Unity Hub 보조 프로세스처럼 -projectPath가 없는 프로세스는 커맨드 라인이 바뀌지 않으므로 다시 볼 필요가 없다.
+            if (instance.createTime != 0)
+            {
+                if (unresolved.size() >= kMaxUnresolved) unresolved.clear();
+                unresolved[pid] = instance.createTime;
+            }
+            continue;
+        }
+
+        // 해석하는 동안 앱이 꺼졌거나, 프로세스가 끝났거나 PID가 재사용됐으면 버린다 (다음 스캔이 다시 본다).
+        if (!AppRegistry::IsEnabled(instance.appId)) continue;
+        if (instance.createTime != 0 && GetProcessCreateTime(pid) != instance.createTime) continue;
         if (activeInstances.find(pid) != activeInstances.end()) continue;
 
-        if (AppInstance instance; ResolveInstance(pid, *def, instance))
+        Track(instance);
+        started.push_back(std::move(instance));
+    }
+}
+
+void ProcessMonitor::OnWindowShown(const HWND hwnd)
+{
+    DWORD pid = 0;
+    GetWindowThreadProcessId(hwnd, &pid);
+    if (pid == 0 || pid == GetCurrentProcessId()) return;
+    if (activeInstances.find(pid) != activeInstances.end() || checkedPids.find(pid) != checkedPids.end()) return;
+
+    if (checkedPids.size() >= kMaxCheckedPids) checkedPids.clear();
+    checkedPids.insert(pid);
+
+    const std::wstring exe = GetProcessExeName(pid);
+    const AppDefinition* def = exe.empty() ? nullptr : AppRegistry::FindByProcessName(exe);
+    if (def == nullptr || !AppRegistry::IsEnabled(def->id)) return;
+    if (FindHelperRoot(pid, exe) != nullptr) return; // 추적 인스턴스가 띄운 같은 exe (렌더 서브프로세스 등)
+
+    SubmitResolve(pid, 0, *def);
+}
+
+bool ProcessMonitor::IsStale(const DWORD pid, const AppInstance &instance) const
+{
+    if (const auto it = exitWatches.find(pid); it != exitWatches.end())
+    {
+        return WaitForSingleObject(it->second->process, 0) == WAIT_OBJECT_0;
+    }
+
+    if (instance.createTime == 0) return false;
+    const uint64_t createTime = GetProcessCreateTime(pid);
+    return createTime != 0 && createTime != instance.createTime;
+}
+
+void ProcessMonitor::RetireStale(const DWORD pid)
+{
+    const auto it = activeInstances.find(pid);
+    if (it == activeInstances.end()) return;
+
+    WT_LOG("[ProcessMonitor] PID " << pid << " no longer belongs to " << it->second.appId << " instance, retiring it");
+    staleInstances.push_back(it->second);
+    Untrack(pid);
+    if (lifecycleNotify) lifecycleNotify();
+}
+
+uint64_t ProcessMonitor::GetProcessCreateTime(const DWORD pid)
+{
+    const HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (hProcess == nullptr) return 0;
+
+    FILETIME creation{}, exitTime{}, kernel{}, user{};
+    uint64_t createTime = 0;
+    if (GetProcessTimes(hProcess, &creation, &exitTime, &kernel, &user))
+    {
+        createTime = (static_cast<uint64_t>(creation.dwHighDateTime) << 32) | creation.dwLowDateTime;
+    }
+    CloseHandle(hProcess);
+    return createTime;
+}
+
+bool ProcessMonitor::SubmitResolve(const DWORD pid, uint64_t createTime, const AppDefinition &def)
+{
+    if (activeInstances.find(pid) != activeInstances.end() || pendingPids.find(pid) != pendingPids.end()) return false;
+
+    // 생성 시각 조회는 핸들 하나로 끝나므로 메인 스레드에서 해도 된다 (비싼 건 커맨드 라인/파일 시스템 쪽).
+    if (createTime == 0) createTime = GetProcessCreateTime(pid);
+
+    if (createTime != 0)
+    {
+        if (const auto it = unresolved.find(pid); it != unresolved.end())
         {
-            activeInstances[pid] = instance;
-            started.push_back(std::move(instance));
+            if (it->second == createTime) return false;
+            unresolved.erase(it); // PID 재사용: 다른 프로세스
         }
     }
 
-    // 3) 더 이상 보이지 않는 PID는 종료된 것으로 판정 (동일 스냅샷으로 diff)
-    auto it = activeInstances.begin();
-    while (it != activeInstances.end())
+    pendingPids.insert(pid);
+    {
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        resolveJobs.push_back(ResolveJob{pid, createTime, &def});
+    }
+    resolveCv.notify_one();
+    return true;
+}
+
+void ProcessMonitor::ResolverThreadFunction()
+{
+    while (true)
     {
-        if (currentPids.find(it->first) == currentPids.end())
+        ResolveJob job;
         {
-            closed.push_back(it->second);
-            it = activeInstances.erase(it);
+            std::unique_lock<std::mutex> lock(resolveMutex);
+            resolveCv.wait(lock, [this] { return resolverStopping || !resolveJobs.empty(); });
+            if (resolverStopping) return;
+            job = resolveJobs.front();
+            resolveJobs.pop_front();
         }
-        else ++it;
+
+        ResolveResult result;
+        result.resolved = ResolveInstance(job.pid, *job.def, result.instance);
+        result.instance.createTime = job.createTime;
+        {
+            std::lock_guard<std::mutex> lock(resolveMutex);
+            resolveResults.push_back(std::move(result));
+        }
+        if (lifecycleNotify) lifecycleNotify();
+    }
+}
+
+void ProcessMonitor::Track(const AppInstance &instance)
+{
+    const DWORD pid = instance.processId;
+    activeInstances.insert_or_assign(pid, instance);
+    checkedPids.erase(pid);
+    if (exitWatches.find(pid) != exitWatches.end()) return;
+
+    // 핸들을 쥐고 있으므로 PID가 재사용돼도 다른 프로세스의 종료로 오인하지 않는다.
+    auto watch = std::make_unique<ExitWatch>(ExitWatch{this, pid, nullptr, nullptr});
+    watch->process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+    if (watch->process == nullptr)
+    {
+        WT_ERR("[ProcessMonitor] Cannot wait for exit of PID " << pid << " (Error: " << GetLastError() << "), relying on scan");
+        return;
+    }
+    if (!RegisterWaitForSingleObject(&watch->wait, watch->process, OnProcessExited, watch.get(),
+                                     INFINITE, WT_EXECUTEONLYONCE))
+    {
+        WT_ERR("[ProcessMonitor] RegisterWaitForSingleObject failed for PID " << pid << " (Error: " << GetLastError() << ")");
+        CloseHandle(watch->process);
+        return;
+    }
+    exitWatches.emplace(pid, std::move(watch));
+}
+
+void ProcessMonitor::Untrack(const DWORD pid)
+{
+    activeInstances.erase(pid);
+    openFiles.Forget(pid);
+
+    const auto it = exitWatches.find(pid);
+    if (it == exitWatches.end()) return;
+
+    UnregisterWaitEx(it->second->wait, INVALID_HANDLE_VALUE);
+    CloseHandle(it->second->process);
+    exitWatches.erase(it);
+
+    // 이미 통지된 종료가 남아 있으면 지운다 (같은 PID를 나중에 재사용한 인스턴스를 닫지 않도록).
+    std::lock_guard<std::mutex> lock(exitedMutex);
+    exitedPids.erase(std::remove(exitedPids.begin(), exitedPids.end(), pid), exitedPids.end());
+}
+
+void CALLBACK ProcessMonitor::OnProcessExited(const PVOID context, BOOLEAN)
+{
+    const auto *watch = static_cast<const ExitWatch *>(context);
+    ProcessMonitor *owner = watch->owner;
+    {
+        std::lock_guard<std::mutex> lock(owner->exitedMutex);
+        owner->exitedPids.push_back(watch->pid);
     }
+    if (owner->lifecycleNotify) owner->lifecycleNotify();
 }
 
 const AppInstance* ProcessMonitor::ResolveByPid(const DWORD pid)
 {
     if (const auto it = activeInstances.find(pid); it != activeInstances.end())
     {
-        return &it->second;
+        if (!IsStale(pid, it->second)) return &it->second;
+
+        // 종료 통지보다 포커스가 먼저 왔고 PID가 이미 재사용됐다: 옛 인스턴스는 종료로 돌리고 새로 해석한다.
+        RetireStale(pid);
     }
 
-    // 맵에 없으면 즉석 해석 (포커스가 스캔보다 먼저 도착한 경우)
+    // 해석 중이면 기다리지 않는다. 결과가 등록되면 메인 스레드가 포커스를 다시 평가한다.
+    if (pendingPids.find(pid) != pendingPids.end()) return nullptr;
+
+    // 추적 인스턴스의 보조 프로세스면 루트 인스턴스로 (따로 해석하지 않는다)
     const std::wstring exe = GetProcessExeName(pid);
+    if (const AppInstance* root = FindHelperRoot(pid, exe)) return root;
+
+    // 처음 보는 PID가 포그라운드로 왔다: 막 뜬 프로세스일 수 있으므로 다음 스캔을 당긴다.
+    if (seenForegroundPids.size() >= kMaxCheckedPids) seenForegroundPids.clear();
+    if (seenForegroundPids.insert(pid).second) TightenScan();
+
+    // 맵에 없으면 해석을 맡긴다 (포커스가 스캔보다 먼저 도착한 경우)
     if (exe.empty()) return nullptr;
 
     const AppDefinition* def = AppRegistry::FindByProcessName(exe);
     if (def == nullptr || !AppRegistry::IsEnabled(def->id)) return nullptr;
 
-    AppInstance instance;
-    if (!ResolveInstance(pid, *def, instance)) return nullptr;
+    SubmitResolve(pid, 0, *def);
+    return nullptr;
+}
+
+void ProcessMonitor::RefreshOpenFile(const DWORD pid, const std::string &titleName)
+{
+    const auto it = activeInstances.find(pid);
+    if (it == activeInstances.end()) return;
+
+    AppInstance &instance = it->second;
+    const AppDefinition *def = AppRegistry::FindById(instance.appId);
+    if (def == nullptr || def->strategy != TrackStrategy::WindowTitle) return;
 
-    const auto [iter, _] = activeInstances.insert_or_assign(pid, std::move(instance));
-    return &iter->second;
+    std::string file = openFiles.Resolve(pid, instance.createTime, def->fileExtensions, titleName);
+    if (file.empty() || file == instance.entity) return;
+
+    WT_LOG("[ProcessMonitor] " << instance.appId << " (PID " << pid << ") has open: " << file);
+    instance.entity = std::move(file);
+    instance.projectPath = GetParentPath(instance.entity);
+    instance.projectName = GetLeafName(instance.projectPath);
 }
 
 void ProcessMonitor::PurgeApp(const std::string& appId)
 {
-    for (auto it = activeInstances.begin(); it != activeInstances.end();)
+    std::vector<DWORD> pids;
+    for (const auto& [pid, instance] : activeInstances)
     {
-        if (it->second.appId == appId) it = activeInstances.erase(it);
-        else ++it;
+        if (instance.appId == appId) pids.push_back(pid);
+    }
+    for (const DWORD pid : pids)
+    {
+        Untrack(pid);
     }
 }
 
@@ -452,52 +1045,30 @@ std::string ProcessMonitor::GetParentPath(const std::string& path)
 
 std::string ProcessMonitor::GetUnityEditorVersion(const std::string& projectPath)
 {
-    const fs::path versionFilePath =
-        fs::path(Utf8ToWide(projectPath)) / L"ProjectSettings" / L"ProjectVersion.txt";
-
-    if (!std::filesystem::exists(versionFilePath)) return "";
-    return ParseProjectVersionFile(versionFilePath);
+    return ParseProjectVersionFile(fs::path(Utf8ToWide(projectPath)) / L"ProjectSettings" / L"ProjectVersion.txt");
 }
 
 std::string ProcessMonitor::ParseProjectVersionFile(const fs::path &versionFilePath)
 {
-    std::ifstream file(versionFilePath);
-    if (!file.is_open()) return "";
-
-    std::string line;
-    while (std::getline(file, line))
-    {
-        if (line.find("m_EditorVersion:") != std::string::npos)
-        {
-            if (const size_t colonPos = line.find(':'); colonPos != std::string::npos)
-            {
-                std::string version = line.substr(colonPos + 1);
+    // 수백 바이트짜리 파일이므로 통째로 읽고 "m_EditorVersion: 2022.3.10f1" 에서 "2022.3"만 꺼낸다.
+    std::ifstream file(versionFilePath, std::ios::binary);
+    if (!file) return "";
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
 
-                version.erase(0, version.find_first_not_of(" \t"));
-                version.erase(version.find_last_not_of(" \t\r\n") + 1);
-
-                if (!version.empty())
-                {
-                    std::vector<std::string> parts;
-                    std::stringstream ss(version);
-                    std::string part;
-
-                    while (std::getline(ss, part, '.'))
-                    {
-                        parts.push_back(part);
-                        if (parts.size() >= 2) break;
-                    }
-
-                    if (parts.size() >= 2)
-                    {
-                        return parts[0] + "." + parts[1];
-                    }
-                }
-            }
-        }
-    }
+    constexpr char kKey[] = "m_EditorVersion:";
+    size_t pos = text.find(kKey);
+    if (pos == std::string::npos) return "";
 
-    return "";
+    pos = text.find_first_not_of(" \t", pos + sizeof(kKey) - 1);
+    if (pos == std::string::npos) return "";
+    const size_t end = text.find_first_of(" \t\r\n", pos);
+    const std::string_view version = std::string_view(text).substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+
+    // major.minor (점이 하나뿐이면 그대로)
+    const size_t firstDot = version.find('.');
+    if (firstDot == std::string_view::npos || firstDot == 0 || firstDot + 1 >= version.size()) return "";
+    const size_t secondDot = version.find('.', firstDot + 1);
+    return std::string(version.substr(0, secondDot));
 }
 
 bool ProcessMonitor::IsUnityProject(const std::string &projectPath)
@@ -0,0 +1,57 @@
+#include "project_metadata_cache.h"
+
+namespace
+{
+    std::wstring Utf8ToWide(const std::string& s)
+    {
+        if (s.empty()) return L"";
+        const int len = MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, nullptr, 0);
+        if (len <= 1) return L"";
+        std::wstring w(static_cast<size_t>(len), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, s.c_str(), -1, w.data(), len);
+        w.resize(static_cast<size_t>(len - 1));
+        return w;
+    }
+}
+
+ProjectMetadata ProjectMetadataCache::Get(const std::string &projectPath, const Loader &load)
+{
+    const std::wstring key = Key(projectPath);
+    const auto now = std::chrono::steady_clock::now();
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const auto it = entries.find(key); it != entries.end())
+        {
+            if (it->second.metadata.valid || now - it->second.loadedAt < kInvalidRetry) return it->second.metadata;
+        }
+        if (const auto it = generations.find(key); it != generations.end()) generation = it->second;
+    }
+
+    ProjectMetadata metadata = load(projectPath);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // 읽는 사이 버전 파일이 바뀌었다: 옛 값일 수 있으므로 캐시하지 않는다.
+    if (const auto it = generations.find(key); it != generations.end() && it->second != generation) return metadata;
+
+    if (entries.size() >= kMaxEntries && entries.find(key) == entries.end()) entries.clear();
+    entries[key] = Entry{metadata, now};
+    return metadata;
+}
+
+void ProjectMetadataCache::Invalidate(const std::string &projectPath)
+{
+    const std::wstring key = Key(projectPath);
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.erase(key);
+    ++generations[key];
+}
+
+std::wstring ProjectMetadataCache::Key(const std::string &projectPath)
+{
+    std::wstring key = fs::path(Utf8ToWide(projectPath)).lexically_normal().make_preferred().wstring();
+    std::transform(key.begin(), key.end(), key.begin(),
+                   [](const wchar_t c) { return static_cast<wchar_t>(::towlower(c)); });
+    while (key.size() > 1 && (key.back() == L'\\' || key.back() == L'/')) key.pop_back();
+    return key;
+}
@@ -415,6 +415,49 @@ HMENU TrayIcon::CreateStatusSubMenu()
                                  L", Failed: " + std::to_wstring(failed) + L")";
     AppendMenuW(subMenu, MF_STRING | MF_GRAYED, 0, heartbeatInfo.c_str());
 
+    // 프로세스 보조 스캔 비용 (깨어난 횟수, 스냅샷/생존 확인, 누적 시간, 현재 주기)
+    if (const auto *monitor = Globals::GetProcessMonitor())
+    {
+        const ProcessScanStats scan = monitor->GetScanStats();
+        const std::wstring scanInfo = L"Process scans: " + std::to_wstring(scan.wakeups) +
+                                      L" (full " + std::to_wstring(scan.fullScans) +
+                                      L", liveness " + std::to_wstring(scan.livenessChecks) +
+                                      L"), " + std::to_wstring(scan.scanMicros / 1000) + L" ms" +
+                                      L", every " + std::to_wstring(scan.intervalMs / 1000) + L" s";
+        AppendMenuW(subMenu, MF_STRING | MF_GRAYED, 0, scanInfo.c_str());
+    }
+
+    // 이벤트 링 backpressure나 임포트 storm이 있었던 프로젝트만 표시
+    if (const auto *watcher = Globals::GetFileWatcher())
+    {
+        for (const auto &project : watcher->GetWatchedProjects())
+        {
+            if (project.heldBackEvents > 0 || project.droppedEvents > 0)
+            {
+                const std::wstring pressureInfo = Utf8ToWideTray(project.projectName) +
+                                                  L": held " + std::to_wstring(project.heldBackEvents) +
+                                                  L", dropped " + std::to_wstring(project.droppedEvents);
+                AppendMenuW(subMenu, MF_STRING | MF_GRAYED, 0, pressureInfo.c_str());
+            }
+            if (project.stormEntries > 0)
+            {
+                const std::wstring stormInfo = Utf8ToWideTray(project.projectName) +
+                                               L": import storms " + std::to_wstring(project.stormEntries) +
+                                               (project.inStorm ? L" (active)" : L"") +
+                                               L", sampled out " + std::to_wstring(project.sampledOutEvents);
+                AppendMenuW(subMenu, MF_STRING | MF_GRAYED, 0, stormInfo.c_str());
+            }
+            if (project.notifyOverflows > 0 || project.notifyResizes > 0)
+            {
+                const std::wstring bufferInfo = Utf8ToWideTray(project.projectName) +
+                                                L": overflows " + std::to_wstring(project.notifyOverflows) +
+                                                L", buffer " + std::to_wstring(project.notifyBufferBytes / 1024) + L" KB" +
+                                                L" (resized " + std::to_wstring(project.notifyResizes) + L")";
+                AppendMenuW(subMenu, MF_STRING | MF_GRAYED, 0, bufferInfo.c_str());
+            }
+        }
+    }
+
     AppendMenuW(subMenu, MF_SEPARATOR, 0, nullptr);
 
     // Actions
@@ -530,7 +573,7 @@ int TrayIcon::RunMessageLoop()
     if (!initialized) return 0;
 
     // 포커스 유지 시 주기 heartbeat(2분)은 항상 설치.
-    // 프로세스 스캔 타이머는 활성 앱 수에 따라 SetProcessScanActive로 동적 제어한다.
+    // 프로세스 스캔 타이머는 활성 앱 수와 스캔 결과에 따라 SetProcessScanInterval로 동적 제어한다.
     SetTimer(hwnd, TIMER_PERIODIC_HEARTBEAT, PERIODIC_HEARTBEAT_INTERVAL_MS, nullptr);
 
     // 정석 메시지 펌프: idle 시 GetMessage가 커널에서 블록되어 CPU ≈ 0.
@@ -550,12 +593,12 @@ int TrayIcon::RunMessageLoop()
     return static_cast<int>(msg.wParam);
 }
 
-void TrayIcon::SetProcessScanActive(const bool active)
+void TrayIcon::SetProcessScanInterval(const UINT intervalMs)
 {
     if (!initialized || hwnd == nullptr) return;
-    if (active)
+    if (intervalMs > 0)
     {
-        SetTimer(hwnd, TIMER_PROCESS_SCAN, PROCESS_SCAN_INTERVAL_MS, nullptr);
+        SetTimer(hwnd, TIMER_PROCESS_SCAN, intervalMs, nullptr); // 같은 ID면 주기만 바꿔 다시 건다
     }
     else
     {
@@ -569,6 +612,12 @@ void TrayIcon::NotifyFileEvent()
     PostMessage(hwnd, WM_APP_FILE_EVENT, 0, 0);
 }
 
+void TrayIcon::NotifyProcessEvent()
+{
+    if (!initialized || hwnd == nullptr) return;
+    PostMessage(hwnd, WM_APP_PROCESS_EVENT, 0, 0);
+}
+
 std::string TrayIcon::ShowApiKeyInputDialog()
 {
     std::string currentApiKey = Globals::GetWakaTimeClient()->GetMaskedApiKey();
@@ -679,6 +728,7 @@ LRESULT TrayIcon::HandleWindowMessage(const HWND hwnd, const UINT msg, const WPA
             {
             case WM_RBUTTONUP:
             {
+                if (onInteraction) onInteraction();
                 POINT pt;
                 GetCursorPos(&pt);
                 ShowContextMenu(pt.x, pt.y);
@@ -686,6 +736,7 @@ LRESULT TrayIcon::HandleWindowMessage(const HWND hwnd, const UINT msg, const WPA
             }
 
             case WM_LBUTTONDBLCLK:
+                    if (onInteraction) onInteraction();
                     if (onShowStatus) onShowStatus();
                     break;
             }
@@ -699,6 +750,10 @@ LRESULT TrayIcon::HandleWindowMessage(const HWND hwnd, const UINT msg, const WPA
             if (onFileEvent) onFileEvent();
             return 0;
 
+        case WM_APP_PROCESS_EVENT:
+            if (onProcessEvent) onProcessEvent();
+            return 0;
+
         case WM_TIMER:
             if (wParam == TIMER_PROCESS_SCAN)
             {
@@ -770,10 +825,10 @@ void TrayIcon::SetCurrentProject(const std::string &projectName)
     SetActiveContext(projectName);
 }
 
-void TrayIcon::IncrementHeartbeats()
+void TrayIcon::AddHeartbeats(const size_t count, const std::string &contextName)
 {
-    totalHeartbeats++;
-    SetActiveContext(activeContext);
+    totalHeartbeats += static_cast<int>(count);
+    SetActiveContext(contextName);
 }
 
 void TrayIcon::SetMonitoringState(const bool monitoring)
@@ -872,6 +927,11 @@ void TrayIcon::SetFileEventCallback(const std::function<void()> &callback)
     onFileEvent = callback;
 }
 
+void TrayIcon::SetProcessEventCallback(const std::function<void()> &callback)
+{
+    onProcessEvent = callback;
+}
+
 void TrayIcon::SetProcessScanCallback(const std::function<void()> &callback)
 {
     onProcessScan = callback;
@@ -882,4 +942,9 @@ void TrayIcon::SetPeriodicTickCallback(const std::function<void()> &callback)
     onPeriodicTick = callback;
 }
 
+void TrayIcon::SetInteractionCallback(const std::function<void()> &callback)
+{
+    onInteraction = callback;
+}
+
 #pragma endregion Callbacks
@@ -1,5 +1,6 @@
 #include "wakatime_client.h"
 #include "app_registry.h"
+#include "git_branch_resolver.h"
 
 #include <cctype>
 
@@ -372,8 +373,18 @@ std::string WakaTimeClient::HeartbeatToJson(const HeartbeatData &heartbeat)
             << R"("editor":")" << heartbeat.editor << "\","
             << R"("operating_system":")" << heartbeat.operating_system << "\","
             << R"("time":)" << heartbeat.time << ","
-            << R"("is_write":)" << (heartbeat.is_write ? "true" : "false")
-            << "}";
+            << R"("is_write":)" << (heartbeat.is_write ? "true" : "false");
+    if (!heartbeat.branch.empty())
+    {
+        json << R"(,"branch":")" << EscapeJsonString(heartbeat.branch) << "\"";
+    }
+    if (heartbeat.lines >= 0)
+    {
+        json << R"(,"lines":)" << heartbeat.lines
+             << R"(,"line_additions":)" << heartbeat.line_additions
+             << R"(,"line_deletions":)" << heartbeat.line_deletions;
+    }
+    json << "}";
 
     return json.str();
 }
@@ -903,7 +914,7 @@ void WakaTimeClient::SenderThreadFunction()
 
 bool WakaTimeClient::SendHeartbeat(const std::string &appId, const std::string &entity,
                                    const std::string &project, const std::string &editorVersion,
-                                   const bool isWrite)
+                                   const bool isWrite, const int64_t time)
 {
     if (!initialized)
     {
@@ -911,10 +922,17 @@ bool WakaTimeClient::SendHeartbeat(const std::string &appId, const std::string &
         return false;
     }
 
+    return EnqueueHeartbeat(BuildHeartbeat(appId, entity, project, editorVersion, isWrite, time));
+}
+
+HeartbeatData WakaTimeClient::BuildHeartbeat(const std::string &appId, const std::string &entity,
+                                             const std::string &project, const std::string &editorVersion,
+                                             const bool isWrite, const int64_t time)
+{
     HeartbeatData heartbeat;
     heartbeat.entity = entity;
     heartbeat.project = project;
-    heartbeat.time = GetUnixTimestamp();
+    heartbeat.time = (time > 0) ? time : GetUnixTimestamp();
     heartbeat.is_write = isWrite;
 
     if (const AppDefinition *def = AppRegistry::FindById(appId))
@@ -928,47 +946,62 @@ bool WakaTimeClient::SendHeartbeat(const std::string &appId, const std::string &
         heartbeat.editor = "Unknown";
     }
 
-    return EnqueueHeartbeat(heartbeat);
+    return heartbeat;
 }
 
 bool WakaTimeClient::EnqueueHeartbeat(const HeartbeatData &heartbeat)
+{
+    return EnqueueHeartbeats(&heartbeat, 1) == 1;
+}
+
+size_t WakaTimeClient::EnqueueHeartbeats(const HeartbeatData *heartbeats, const size_t count)
 {
     if (!initialized)
     {
         WT_ERR("[WakaTimeClient] Not initialized, cannot enqueue heartbeat");
-        return false;
+        return 0;
     }
 
     // Pause Monitoring 전역 게이트: 모든 소스(파일/포커스)의 heartbeat를 단일 chokepoint에서 차단.
-    if (g_monitoringPaused.load(std::memory_order_acquire))
+    if (g_monitoringPaused.load(std::memory_order_acquire) || count == 0)
     {
-        return false;
+        return 0;
     }
 
-    // 큐에 추가 (비동기 전송)
+    size_t queued = 0;
+
+    // 큐에 추가 (비동기 전송). 배치 전체를 락 1회로 처리한다.
     {
         std::lock_guard<std::mutex> lock(queueMutex);
 
         const auto now = std::chrono::steady_clock::now();
-        // entity + project를 \x1f(unit separator)로 결합해 컨텍스트별 키 생성
-        const std::string key = heartbeat.entity + '\x1f' + heartbeat.project;
+        std::string key;
 
-        if (const auto it = lastQueuedByEntity.find(key); it != lastQueuedByEntity.end())
+        for (size_t i = 0; i < count; ++i)
         {
-            const auto elapsed = now - it->second;
-            const auto minInterval = heartbeat.is_write ? kSameFileWriteInterval : kSameFileHeartbeatInterval;
-            if (elapsed < minInterval)
+            const HeartbeatData &heartbeat = heartbeats[i];
+
+            // entity + project를 \x1f(unit separator)로 결합해 컨텍스트별 키 생성
+            key.assign(heartbeat.entity).append(1, '\x1f').append(heartbeat.project);
+
+            if (const auto it = lastQueuedByEntity.find(key); it != lastQueuedByEntity.end())
             {
-                return false;
+                const auto elapsed = now - it->second;
+                const auto minInterval = heartbeat.is_write ? kSameFileWriteInterval : kSameFileHeartbeatInterval;
+                if (elapsed < minInterval)
+                {
+                    continue;
+                }
             }
-        }
 
-        while (heartbeatQueue.size() >= kMaxHeartbeatQueueSize)
-        {
-            heartbeatQueue.pop(); // 메모리 폭주 방지를 위해 가장 오래된 heartbeat 제거
+            while (heartbeatQueue.size() >= kMaxHeartbeatQueueSize)
+            {
+                heartbeatQueue.pop(); // 메모리 폭주 방지를 위해 가장 오래된 heartbeat 제거
+            }
+            heartbeatQueue.push(heartbeat);
+            lastQueuedByEntity[key] = now;
+            ++queued;
         }
-        heartbeatQueue.push(heartbeat);
-        lastQueuedByEntity[key] = now;
 
         // debounce 맵 무한 증가 방지: 상한 초과 시 만료(>heartbeat interval)된 엔트리 정리.
         // 그래도 상한을 넘으면 가장 오래된 엔트리를 제거한다.
@@ -996,17 +1029,42 @@ bool WakaTimeClient::EnqueueHeartbeat(const HeartbeatData &heartbeat)
                 lastQueuedByEntity.erase(oldest);
             }
         }
+    }
 
+    if (queued > 0)
+    {
         queueCv.notify_one();
     }
 
-    return true;
+    return queued;
 }
 
-bool WakaTimeClient::SendHeartbeatFromEvent(const FileChangeEvent &event)
+size_t WakaTimeClient::SendHeartbeatsFromEvents(const FileChangeEvent *events, const size_t count)
 {
-    const bool isWrite = (event.action == FILE_ACTION_MODIFIED || event.action == FILE_ACTION_ADDED || event.action == FILE_ACTION_RENAMED_NEW_NAME);
-    return SendHeartbeat(event.appId, event.filePath, event.projectName, "", isWrite);
+    if (!initialized || count == 0) return 0;
+
+    std::vector<HeartbeatData> heartbeats;
+    heartbeats.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const FileChangeEvent &event = events[i];
+        const bool isWrite = (event.action == FILE_ACTION_MODIFIED || event.action == FILE_ACTION_ADDED || event.action == FILE_ACTION_RENAMED_NEW_NAME);
+        const int64_t time = std::chrono::duration_cast<std::chrono::seconds>(event.timestamp.time_since_epoch()).count();
+        HeartbeatData heartbeat = BuildHeartbeat(event.context->appId, event.FullPath(), event.context->projectName, "", isWrite, time);
+        if (event.context->git != nullptr && !event.IsExternal())
+        {
+            heartbeat.branch = event.context->git->Branch();
+        }
+        if (event.lines >= 0)
+        {
+            heartbeat.lines = event.lines;
+            heartbeat.line_additions = std::max<int64_t>(event.lineDelta, 0);
+            heartbeat.line_deletions = std::max<int64_t>(-event.lineDelta, 0);
+        }
+        heartbeats.push_back(std::move(heartbeat));
+    }
+
+    return EnqueueHeartbeats(heartbeats.data(), heartbeats.size());
 }
 
 size_t WakaTimeClient::GetQueueSize() const
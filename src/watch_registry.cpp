@@ -0,0 +1,554 @@
+#include "watch_registry.h"
+
+#include <cwctype>
+
+namespace
+{
+    // I/O 스레드 종료 요청 패킷의 completion key (감시는 Watch 포인터를 key로 쓴다)
+    constexpr ULONG_PTR kQuitKey = 0;
+
+    constexpr DWORD kNotifyFilter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_CREATION | FILE_NOTIFY_CHANGE_FILE_NAME;
+
+    std::string WideToUtf8(const std::wstring& w)
+    {
+        if (w.empty()) return "";
+        const int len = WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                                            nullptr, 0, nullptr, nullptr);
+        if (len <= 0) return "";
+        std::string s(static_cast<size_t>(len), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, w.c_str(), static_cast<int>(w.size()),
+                            s.data(), len, nullptr, nullptr);
+        return s;
+    }
+
+    HANDLE OpenDirectory(const std::wstring &directory, const DWORD flags)
+    {
+        return CreateFileW(directory.c_str(),
+                           FILE_LIST_DIRECTORY,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                           nullptr,
+                           OPEN_EXISTING,
+                           FILE_FLAG_BACKUP_SEMANTICS | flags,
+                           nullptr);
+    }
+
+    std::wstring FinalPathOf(const HANDLE handle)
+    {
+        std::wstring path(MAX_PATH, L'\0');
+        DWORD len = GetFinalPathNameByHandleW(handle, path.data(), static_cast<DWORD>(path.size()),
+                                              FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+        if (len >= path.size())
+        {
+            path.resize(len + 1);
+            len = GetFinalPathNameByHandleW(handle, path.data(), static_cast<DWORD>(path.size()),
+                                            FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+        }
+        if (len == 0 || len >= path.size()) return L"";
+        path.resize(len);
+
+        // \\?\C:\x → C:\x, \\?\UNC\server\share → \\server\share
+        if (path.compare(0, 8, L"\\\\?\\UNC\\") == 0) path = L"\\\\" + path.substr(8);
+        else if (path.compare(0, 4, L"\\\\?\\") == 0) path.erase(0, 4);
+
+        // 루트("C:\")가 아니면 끝 구분자 제거
+        while (path.size() > 3 && path.back() == L'\\') path.pop_back();
+
+        std::transform(path.begin(), path.end(), path.begin(),
+                       [](const wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+        return path;
+    }
+
+    bool StartsWithNoCase(const wchar_t *text, const size_t length, const std::wstring &prefix)
+    {
+        if (length < prefix.size()) return false;
+        for (size_t i = 0; i < prefix.size(); ++i)
+        {
+            if (static_cast<wchar_t>(std::towlower(text[i])) != prefix[i]) return false;
+        }
+        return true;
+    }
+}
+
+WatchRegistry::WatchRegistry() :
+    bufferPool(Config::NOTIFY_BUFFER_MIN_SIZE, Config::NOTIFY_BUFFER_MAX_SIZE, Config::NOTIFY_BUFFER_TOTAL_CAP),
+    completionPort(CreateIoCompletionPort(INVALID_HANDLE_VALUE, nullptr, 0, 1))
+{
+    if (completionPort == nullptr)
+    {
+        WT_ERR("[WatchRegistry] Failed to create completion port (Error: " << GetLastError() << ")");
+        return;
+    }
+
+    try
+    {
+        ioThread = std::thread(&WatchRegistry::IoThread, this);
+    }
+    catch (const std::system_error &e)
+    {
+        WT_ERR("[WatchRegistry] Failed to start I/O thread: " << e.what());
+    }
+}
+
+WatchRegistry::~WatchRegistry()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        while (!watches.empty())
+        {
+            Retire(watches.begin());
+        }
+    }
+
+    if (ioThread.joinable())
+    {
+        PostQueuedCompletionStatus(completionPort, 0, kQuitKey, nullptr);
+        ioThread.join();
+    }
+
+    // I/O 스레드가 없으면 취소 완료를 기다릴 수 없으므로 여기서 동기로 기다린다.
+    for (const auto &watch : retired)
+    {
+        if (watch->pending)
+        {
+            DWORD ignored = 0;
+            GetOverlappedResult(watch->directoryHandle, &watch->overlapped, &ignored, TRUE);
+        }
+        CloseHandle(watch->directoryHandle);
+    }
+    retired.clear();
+
+    if (completionPort != nullptr)
+    {
+        CloseHandle(completionPort);
+        completionPort = nullptr;
+    }
+}
+
+std::wstring WatchRegistry::CanonicalPath(const std::wstring &directory)
+{
+    const HANDLE handle = OpenDirectory(directory, 0);
+    if (handle == INVALID_HANDLE_VALUE) return L"";
+
+    std::wstring path = FinalPathOf(handle);
+    CloseHandle(handle);
+    return path;
+}
+
+bool WatchRegistry::IsWithin(const std::wstring &path, const std::wstring &ancestor, std::wstring *remainder)
+{
+    if (ancestor.empty() || path.compare(0, ancestor.size(), ancestor) != 0) return false;
+
+    if (path.size() == ancestor.size())
+    {
+        if (remainder != nullptr) remainder->clear();
+        return true;
+    }
+
+    // "c:\" 처럼 구분자로 끝나는 루트는 그대로, 아니면 다음 글자가 구분자여야 하위다 (c:\ab ⊄ c:\a).
+    size_t start = ancestor.size();
+    if (ancestor.back() != L'\\')
+    {
+        if (path[start] != L'\\') return false;
+        ++start;
+    }
+    if (remainder != nullptr) *remainder = path.substr(start);
+    return true;
+}
+
+WatchRegistry::SubscriptionId WatchRegistry::Subscribe(const std::wstring &directory,
+                                                       std::shared_ptr<WatchInbox> inbox, const size_t rootTag,
+                                                       const bool recursive)
+{
+    if (completionPort == nullptr || !ioThread.joinable() || !inbox || inbox->event == nullptr) return 0;
+
+    const HANDLE handle = OpenDirectory(directory, FILE_FLAG_OVERLAPPED);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        WT_ERR("[WatchRegistry] Failed to open directory: " << WideToUtf8(directory) << " (Error: " << GetLastError() << ")");
+        return 0;
+    }
+
+    const std::wstring key = FinalPathOf(handle);
+    if (key.empty())
+    {
+        WT_ERR("[WatchRegistry] Failed to resolve directory: " << WideToUtf8(directory) << " (Error: " << GetLastError() << ")");
+        CloseHandle(handle);
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stopping)
+    {
+        CloseHandle(handle);
+        return 0;
+    }
+
+    const SubscriptionId id = nextId++;
+
+    // 같은 디렉토리나 상위 디렉토리를 이미 감시 중이면 구독자만 붙인다.
+    // 비재귀 감시에는 같은 디렉토리의 비재귀 구독만 붙는다.
+    for (const auto &watch : watches)
+    {
+        std::wstring remainder;
+        if (!IsWithin(key, watch->key, &remainder)) continue;
+        if (!watch->recursive && (recursive || !remainder.empty())) continue;
+
+        CloseHandle(handle);
+        if (!remainder.empty()) remainder += L'\\';
+        watch->subscribers.push_back(Subscriber{id, std::move(inbox), rootTag, std::move(remainder), recursive});
+        WT_LOG("[WatchRegistry] Shared watch " << WideToUtf8(watch->key) << " (" << watch->subscribers.size() << " subscriber(s))");
+        return id;
+    }
+
+    // 새 감시는 최소 버퍼로 시작한다 (조용한 프로젝트는 몇 KB만 쓴다).
+    auto watch = OpenWatch(handle, key, bufferPool.Acquire(bufferPool.MinSize()), recursive);
+    if (watch == nullptr) return 0;
+    watch->subscribers.push_back(Subscriber{id, std::move(inbox), rootTag, std::wstring(), recursive});
+
+    // 새 재귀 감시가 기존 감시를 포함하면 기존 구독자를 옮겨 붙이고 기존 커널 감시는 닫는다.
+    for (auto it = watches.begin(); recursive && it != watches.end();)
+    {
+        std::wstring remainder;
+        if (!IsWithin((*it)->key, key, &remainder))
+        {
+            ++it;
+            continue;
+        }
+
+        for (auto &subscriber : (*it)->subscribers)
+        {
+            subscriber.filter = remainder + L'\\' + subscriber.filter;
+            watch->subscribers.push_back(std::move(subscriber));
+        }
+        (*it)->subscribers.clear();
+        WT_LOG("[WatchRegistry] Merged watch " << WideToUtf8((*it)->key) << " into " << WideToUtf8(key));
+
+        const size_t offset = static_cast<size_t>(it - watches.begin());
+        Retire(it);
+        it = watches.begin() + static_cast<std::ptrdiff_t>(offset);
+    }
+
+    WT_LOG("[WatchRegistry] Watching " << WideToUtf8(key));
+    watches.push_back(std::move(watch));
+    return id;
+}
+
+void WatchRegistry::Unsubscribe(const SubscriptionId id)
+{
+    if (id == 0) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = watches.begin(); it != watches.end(); ++it)
+    {
+        auto &subscribers = (*it)->subscribers;
+        const auto found = std::find_if(subscribers.begin(), subscribers.end(),
+                                        [id](const Subscriber &subscriber) { return subscriber.id == id; });
+        if (found == subscribers.end()) continue;
+
+        subscribers.erase(found);
+        // 합쳐진 넓은 감시는 남은 구독자가 있는 동안 그대로 둔다 (다시 좁히지 않는다).
+        if (subscribers.empty())
+        {
+            WT_LOG("[WatchRegistry] Closing watch " << WideToUtf8((*it)->key));
+            Retire(it);
+        }
+        return;
+    }
+}
+
+WatchRegistry::WatchStats WatchRegistry::GetStats(const SubscriptionId id) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &watch : watches)
+    {
+        for (const auto &subscriber : watch->subscribers)
+        {
+            if (subscriber.id == id) return WatchStats{watch->buffer.Size(), watch->overflows, watch->resizes};
+        }
+    }
+    return WatchStats{};
+}
+
+size_t WatchRegistry::KernelWatchCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return watches.size();
+}
+
+std::unique_ptr<WatchRegistry::Watch> WatchRegistry::OpenWatch(const HANDLE handle, const std::wstring &key,
+                                                               NotifyBufferPool::Buffer buffer, const bool recursive,
+                                                               DWORD *armError)
+{
+    auto watch = std::make_unique<Watch>();
+    watch->key = key;
+    watch->directoryHandle = handle;
+    watch->recursive = recursive;
+    watch->buffer = std::move(buffer);
+    watch->maxBufferSize = bufferPool.MaxSize();
+    watch->lastResize = std::chrono::steady_clock::now();
+
+    if (CreateIoCompletionPort(handle, completionPort, reinterpret_cast<ULONG_PTR>(watch.get()), 0) == nullptr)
+    {
+        if (armError != nullptr) *armError = GetLastError();
+        WT_ERR("[WatchRegistry] Failed to bind directory to completion port: " << WideToUtf8(key) << " (Error: " << GetLastError() << ")");
+        CloseHandle(handle);
+        return nullptr;
+    }
+    if (!Arm(*watch, armError))
+    {
+        CloseHandle(handle);
+        return nullptr;
+    }
+    return watch;
+}
+
+bool WatchRegistry::Arm(Watch &watch, DWORD *error)
+{
+    for (int attempt = 0; attempt < 2; ++attempt)
+    {
+        ZeroMemory(&watch.overlapped, sizeof(OVERLAPPED));
+        if (ReadDirectoryChangesW(watch.directoryHandle, watch.buffer.Data(), static_cast<DWORD>(watch.buffer.Size()), watch.recursive ? TRUE : FALSE,
+                                  kNotifyFilter, nullptr, &watch.overlapped, nullptr))
+        {
+            watch.pending = true;
+            return true;
+        }
+
+        const DWORD lastError = GetLastError();
+        if (error != nullptr) *error = lastError;
+        if (lastError != ERROR_NOTIFY_ENUM_DIR)
+        {
+            WT_ERR("[WatchRegistry] ReadDirectoryChangesW failed for " << WideToUtf8(watch.key) << " (Error: " << lastError << ")");
+            break;
+        }
+
+        // 버퍼 오버플로(대량 변경): 개별 이벤트 유실. 구독자가 재스캔으로 메우고 재발급으로 계속 감시.
+        WT_ERR("[WatchRegistry] Notify buffer overflow for " << WideToUtf8(watch.key) << ", continuing");
+        ++watch.overflows;
+        Dispatch(watch, 0);
+    }
+
+    watch.pending = false;
+    return false;
+}
+
+bool WatchRegistry::Resize(const std::vector<std::unique_ptr<Watch>>::iterator it, const size_t bufferSize)
+{
+    Watch &current = **it;
+
+    // 상한에 걸려 키우려던 버퍼가 지금보다 크지 않으면(줄이려던 버퍼가 작지 않으면) 다시 열어 봐야 유실 구간만 생긴다.
+    NotifyBufferPool::Buffer buffer = bufferPool.Acquire(bufferSize);
+    const bool grow = bufferSize > current.buffer.Size();
+    if (grow ? buffer.Size() <= current.buffer.Size() : buffer.Size() >= current.buffer.Size())
+    {
+        current.lastResize = std::chrono::steady_clock::now();
+        return false;
+    }
+
+    const HANDLE handle = OpenDirectory(current.key, FILE_FLAG_OVERLAPPED);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        WT_ERR("[WatchRegistry] Failed to reopen " << WideToUtf8(current.key) << " for resize (Error: " << GetLastError() << ")");
+        return false;
+    }
+
+    DWORD error = 0;
+    auto replacement = OpenWatch(handle, current.key, std::move(buffer), current.recursive, &error);
+    if (replacement == nullptr)
+    {
+        // 네트워크 공유 폴더: 64KB를 넘는 버퍼는 거부된다. 이 감시는 그 이상 키우지 않는다.
+        if (error == ERROR_INVALID_PARAMETER && bufferSize > kNetworkBufferLimit)
+        {
+            current.maxBufferSize = std::max(current.buffer.Size(), kNetworkBufferLimit);
+        }
+        current.lastResize = std::chrono::steady_clock::now();
+        return false;
+    }
+
+    WT_LOG("[WatchRegistry] Resized notify buffer for " << WideToUtf8(current.key) << ": "
+           << current.buffer.Size() / 1024 << " KB -> " << replacement->buffer.Size() / 1024 << " KB");
+
+    replacement->subscribers = std::move(current.subscribers);
+    replacement->maxBufferSize = std::min(current.maxBufferSize, replacement->maxBufferSize);
+    replacement->overflows = current.overflows;
+    replacement->resizes = current.resizes + 1;
+    current.subscribers.clear();
+
+    std::swap(*it, replacement);
+    // 이제 replacement가 기존 감시를 들고 있다. 목록 끝에 잠깐 넣었다가 Retire로 닫는다.
+    watches.push_back(std::move(replacement));
+    Retire(watches.end() - 1);
+    return true;
+}
+
+void WatchRegistry::ShrinkQuietWatches()
+{
+    const auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < watches.size(); ++i)
+    {
+        Watch &watch = *watches[i];
+        if (watch.buffer.Size() <= bufferPool.MinSize() || now - watch.lastResize < kShrinkAfterQuiet) continue;
+
+        // 마지막 크기 변경 이후 받은 최대량의 2배(최소 크기 이상)로 줄인다. 사용량이 1/4 이상이면 그대로 둔다.
+        if (watch.peakBytes * 4 >= watch.buffer.Size())
+        {
+            watch.peakBytes = 0;
+            watch.lastResize = now;
+            continue;
+        }
+        Resize(watches.begin() + static_cast<std::ptrdiff_t>(i), std::max(bufferPool.MinSize(), watch.peakBytes * 2));
+    }
+}
+
+void WatchRegistry::Retire(const std::vector<std::unique_ptr<Watch>>::iterator it)
+{
+    std::unique_ptr<Watch> watch = std::move(*it);
+    watches.erase(it);
+
+    if (watch->pending)
+    {
+        // 취소 완료 패킷을 받은 I/O 스레드가 핸들을 닫고 버퍼를 해제한다.
+        CancelIoEx(watch->directoryHandle, &watch->overlapped);
+        retired.push_back(std::move(watch));
+        return;
+    }
+    CloseHandle(watch->directoryHandle);
+}
+
+void WatchRegistry::IoThread()
+{
+    while (true)
+    {
+        DWORD bytes = 0;
+        ULONG_PTR key = 0;
+        OVERLAPPED *overlapped = nullptr;
+        const BOOL ok = GetQueuedCompletionStatus(completionPort, &bytes, &key, &overlapped, kRebalanceIntervalMs);
+        if (overlapped == nullptr)
+        {
+            if (!ok && GetLastError() == WAIT_TIMEOUT)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ShrinkQuietWatches();
+                continue;
+            }
+            if (!ok)
+            {
+                WT_ERR("[WatchRegistry] GetQueuedCompletionStatus failed (Error: " << GetLastError() << ")");
+                return;
+            }
+            if (key != kQuitKey) continue;
+
+            // 종료 요청: 남은 취소 완료를 마저 받고 끝낸다.
+            std::lock_guard<std::mutex> lock(mutex);
+            if (retired.empty()) return;
+            PostQueuedCompletionStatus(completionPort, 0, kQuitKey, nullptr);
+            continue;
+        }
+
+        auto *completed = reinterpret_cast<Watch *>(key);
+        std::lock_guard<std::mutex> lock(mutex);
+        completed->pending = false;
+
+        const auto retiredIt = std::find_if(retired.begin(), retired.end(),
+                                            [completed](const std::unique_ptr<Watch> &watch) { return watch.get() == completed; });
+        if (retiredIt != retired.end())
+        {
+            CloseHandle(completed->directoryHandle);
+            retired.erase(retiredIt);
+            continue;
+        }
+
+        if (ok)
+        {
+            Dispatch(*completed, bytes);
+            completed->peakBytes = std::max<size_t>(completed->peakBytes, bytes);
+
+            // 0바이트 완료 = 커널 버퍼 오버플로. 키울 수 있으면 더 큰 버퍼로 감시를 교체한다 (교체하면 기존 감시는 닫힌다).
+            if (bytes == 0)
+            {
+                ++completed->overflows;
+                const auto it = std::find_if(watches.begin(), watches.end(),
+                                             [completed](const std::unique_ptr<Watch> &watch) { return watch.get() == completed; });
+                if (it != watches.end() && completed->buffer.Size() < completed->maxBufferSize &&
+                    Resize(it, std::min(completed->buffer.Size() * kGrowFactor, completed->maxBufferSize)))
+                {
+                    continue;
+                }
+            }
+        }
+        else if (const DWORD error = GetLastError(); error != ERROR_OPERATION_ABORTED)
+        {
+            WT_ERR("[WatchRegistry] Watch completion failed for " << WideToUtf8(completed->key) << " (Error: " << error << ")");
+        }
+
+        if (!Arm(*completed))
+        {
+            // 감시 디렉토리가 지워졌거나 접근이 끊겼다. 구독자는 남지만 더 이상 알림이 오지 않는다.
+            WT_ERR("[WatchRegistry] Stopped watching " << WideToUtf8(completed->key));
+        }
+    }
+}
+
+void WatchRegistry::Dispatch(const Watch &watch, const DWORD bytes)
+{
+    std::vector<std::vector<WatchInbox::Notification>> batches(watch.subscribers.size());
+
+    if (bytes == 0)
+    {
+        for (size_t i = 0; i < watch.subscribers.size(); ++i)
+        {
+            batches[i].push_back(WatchInbox::Notification{watch.subscribers[i].rootTag, std::string(), 0});
+        }
+    }
+    else
+    {
+        const auto *info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(watch.buffer.Data());
+        while (true)
+        {
+            const wchar_t *name = info->FileName;
+            const size_t length = info->FileNameLength / sizeof(WCHAR);
+
+            // 레코드 1건을 구독 범위(filter)에 드는 구독자 모두에게 나눠 준다.
+            for (size_t i = 0; i < watch.subscribers.size(); ++i)
+            {
+                const Subscriber &subscriber = watch.subscribers[i];
+                if (!StartsWithNoCase(name, length, subscriber.filter) || length == subscriber.filter.size()) continue;
+                // 비재귀 구독은 filter 바로 아래 항목만 (재귀 감시를 공유할 때)
+                if (!subscriber.recursive &&
+                    std::find(name + subscriber.filter.size(), name + length, L'\\') != name + length) continue;
+
+                std::string path = WideToUtf8(std::wstring(name + subscriber.filter.size(), length - subscriber.filter.size()));
+                std::replace(path.begin(), path.end(), '\\', '/');
+                batches[i].push_back(WatchInbox::Notification{subscriber.rootTag, std::move(path), info->Action});
+            }
+
+            if (info->NextEntryOffset == 0) break;
+            info = reinterpret_cast<const FILE_NOTIFY_INFORMATION *>(reinterpret_cast<const char *>(info) + info->NextEntryOffset);
+        }
+    }
+
+    for (size_t i = 0; i < watch.subscribers.size(); ++i)
+    {
+        if (!batches[i].empty()) Deliver(watch.subscribers[i], batches[i]);
+    }
+}
+
+void WatchRegistry::Deliver(const Subscriber &subscriber, std::vector<WatchInbox::Notification> &items)
+{
+    WatchInbox &inbox = *subscriber.inbox;
+    {
+        std::lock_guard<std::mutex> lock(inbox.mutex);
+        if (inbox.items.size() + items.size() > kMaxInboxItems)
+        {
+            // 구독자가 밀렸다: 개별 알림 대신 재스캔을 요청한다. 다른 구독의 알림도 함께 버렸으므로 태그는 구독자 전체용이다.
+            inbox.items.clear();
+            inbox.items.push_back(WatchInbox::Notification{WatchInbox::kOverflowTag, std::string(), 0});
+        }
+        else
+        {
+            std::move(items.begin(), items.end(), std::back_inserter(inbox.items));
+        }
+    }
+    SetEvent(inbox.event);
+}
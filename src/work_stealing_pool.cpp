@@ -0,0 +1,145 @@
+#include "work_stealing_pool.h"
+
+namespace
+{
+    // 현재 스레드가 어느 풀의 몇 번 워커인지 (Spawn 대상 deque 결정용)
+    thread_local const WorkStealingPool *tlsPool = nullptr;
+    thread_local size_t tlsWorker = 0;
+
+    // 훔칠 작업이 없을 때 바로 잠들지 않고 잠깐 양보하다가, 오래 비면 짧게 잔다.
+    constexpr int kSpinsBeforeSleep = 64;
+}
+
+WorkStealingPool::WorkStealingPool(size_t workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::thread::hardware_concurrency();
+    }
+    workerCount = std::clamp<size_t>(workerCount, 1, kMaxWorkers);
+
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+    }
+}
+
+bool WorkStealingPool::Run(std::vector<Task> seeds, const std::atomic<bool> &cancel)
+{
+    if (seeds.empty()) return true;
+
+    cancelFlag = &cancel;
+    outstanding.store(seeds.size(), std::memory_order_release);
+    for (size_t i = 0; i < seeds.size(); ++i)
+    {
+        Worker &worker = *workers[i % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(seeds[i]));
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size() - 1);
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        try
+        {
+            threads.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+        }
+        catch (const std::system_error &e)
+        {
+            // 스레드를 못 만들어도 남은 워커가 훔쳐 가므로 결과는 같다 (느릴 뿐).
+            WT_ERR("[WorkStealingPool] Failed to start worker " << i << ": " << e.what());
+            break;
+        }
+    }
+
+    WorkerLoop(0);
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    const bool completed = outstanding.load(std::memory_order_acquire) == 0;
+    for (auto &worker : workers)
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.clear();
+    }
+    outstanding.store(0, std::memory_order_release);
+    cancelFlag = nullptr;
+
+    return completed && !cancel;
+}
+
+void WorkStealingPool::Spawn(Task task)
+{
+    const size_t index = (tlsPool == this) ? tlsWorker : 0;
+
+    outstanding.fetch_add(1, std::memory_order_acq_rel);
+    Worker &worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+}
+
+void WorkStealingPool::WorkerLoop(const size_t index)
+{
+    tlsPool = this;
+    tlsWorker = index;
+
+    int idleSpins = 0;
+    while (outstanding.load(std::memory_order_acquire) > 0)
+    {
+        if (cancelFlag != nullptr && cancelFlag->load(std::memory_order_relaxed)) break;
+
+        Task task;
+        if (TryPop(index, task) || TrySteal(index, task))
+        {
+            idleSpins = 0;
+            task();
+            outstanding.fetch_sub(1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        // 다른 워커의 작업이 하위 작업을 Spawn할 수 있으므로 outstanding이 0이 될 때까지 기다린다.
+        if (++idleSpins < kSpinsBeforeSleep)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    tlsPool = nullptr;
+}
+
+bool WorkStealingPool::TryPop(const size_t index, Task &task)
+{
+    Worker &worker = *workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) return false;
+
+    // 자기 작업은 LIFO: 방금 Spawn한 하위 디렉토리를 먼저 처리해 캐시 지역성을 유지
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::TrySteal(const size_t index, Task &task)
+{
+    for (size_t offset = 1; offset < workers.size(); ++offset)
+    {
+        Worker &victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) continue;
+
+        // 남의 작업은 FIFO: 트리 위쪽(큰 작업)을 가져가 분할 효과를 키운다
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}